@@ -0,0 +1,27 @@
+#include "allocation_counter.h"
+#include <cstdlib>
+#include <new>
+
+using namespace ccnet;
+
+std::atomic<std::uint64_t> ccnet::allocations_count(0);
+
+void* operator new(std::size_t size) {
+	allocations_count.fetch_add(1, std::memory_order_relaxed);
+
+	void* memory = std::malloc(size == 0 ? 1 : size);
+
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
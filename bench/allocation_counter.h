@@ -0,0 +1,15 @@
+#ifndef CCNET_ALLOCATION_COUNTER_H
+#define CCNET_ALLOCATION_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace ccnet {
+
+	// the number of the heap allocations made by the program so far,
+	// counted by the replaced global operator new of allocation_counter.cpp
+	extern std::atomic<std::uint64_t> allocations_count;
+
+}
+
+#endif // CCNET_ALLOCATION_COUNTER_H
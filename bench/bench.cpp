@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include "allocation_counter.h"
+#include "bill_table_index.h"
+#include "bill_validator.h"
+#include "codec.h"
+#include "crc16_engine.h"
+#include "frame.h"
+#include "frame_parser.h"
+#include "loopback_device.h"
+#include "loopback_transport.h"
+#include "protocol.h"
+
+using namespace ccnet;
+
+// measures the protocol hot paths in nanoseconds and heap allocations per operation
+
+const std::uint8_t device_address = 0x03;
+const std::uint8_t poll_command = 0x33;
+const std::uint8_t enable_bill_types_command = 0x34;
+const std::uint8_t idling_state = 0x14;
+
+// the least time a benchmark runs for
+const std::chrono::milliseconds measurement_time(200);
+
+// keeps the results of the measured operations alive
+volatile std::uint64_t sink = 0;
+
+template<typename Operation>
+void run_benchmark(const char* name, Operation operation) {
+	typedef std::chrono::steady_clock clock;
+
+	for (int i = 0; i < 1000; ++i) {
+		operation();
+	}
+
+	for (std::uint64_t iterations_count = 1000; ; iterations_count *= 2) {
+		const std::uint64_t allocations_before = allocations_count.load(std::memory_order_relaxed);
+		const clock::time_point start_time = clock::now();
+
+		for (std::uint64_t i = 0; i < iterations_count; ++i) {
+			operation();
+		}
+
+		const clock::duration duration = clock::now() - start_time;
+		const std::uint64_t allocations = allocations_count.load(std::memory_order_relaxed) - allocations_before;
+
+		if (duration >= measurement_time) {
+			std::printf("%-40s %12.1f ns/op %10.2f allocs/op\n", name,
+				(double)std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / iterations_count,
+				(double)allocations / iterations_count);
+			return;
+		}
+	}
+}
+
+// the handler never waits for the operator while the device is idling
+class idle_operator : public bill_validator_operator {
+	public:
+		std::future<void> drop_cassette_full() override {
+			return std::future<void>();
+		}
+
+		std::future<void> drop_cassette_installed() override {
+			return std::future<void>();
+		}
+
+		std::future<void> drop_cassette_removed() override {
+			return std::future<void>();
+		}
+
+		std::future<cash_action> request_cash_action(const cash_type& cash_type) override {
+			return std::future<cash_action>();
+		}
+
+		std::future<void> cash_accepted(const cash_type& cash_type) override {
+			return std::future<void>();
+		}
+
+		std::future<void> cash_returned(const cash_type& cash_type) override {
+			return std::future<void>();
+		}
+};
+
+// passes the frame bytes to the parser as a single read would
+void receive(frame_parser& parser, const frame& received_frame) {
+	std::size_t offset = 0;
+
+	while (offset < received_frame.size()) {
+		const std::size_t size = std::min(parser.get_write_size(), received_frame.size() - offset);
+		std::copy(received_frame.data() + offset, received_frame.data() + offset + size, parser.get_write_position());
+		parser.commit(size);
+		offset += size;
+	}
+}
+
+// the handler of a bill validator polling a device idling on an in-memory line as fast as its worker steps it:
+// the poll, the response and the confirmation pass through the bus, the transport and the parser
+// as they do on a serial line, only the line silence is left out
+void run_poll_round_trip_benchmark(const char* name) {
+	typedef std::chrono::steady_clock clock;
+
+	loopback_device device;
+
+	{
+		idle_operator validator_operator;
+		const poll_policy policy(std::chrono::milliseconds(0), std::chrono::milliseconds(0), std::chrono::milliseconds(0), std::chrono::milliseconds(1000), std::chrono::milliseconds(0));
+		connection_options options(9600, 8, connection_options::parity_type::none, connection_options::stop_bits_type::one,
+			std::chrono::milliseconds(10), std::chrono::milliseconds(5), std::chrono::milliseconds(0), std::chrono::milliseconds(0));
+		options.custom_transport = [&device](const std::string& port_name, const connection_options& options) {
+			return std::unique_ptr<serial_transport>(new loopback_transport([&device](const frame& written_frame, frame& response) {
+				device.respond(written_frame, response);
+			}));
+		};
+		bill_validator validator("loopback", &validator_operator, policy, escrow_policy(), options);
+
+		const clock::time_point initialization_deadline = clock::now() + std::chrono::seconds(5);
+		while (!validator.get_snapshot()->is_initialized) {
+			if (clock::now() >= initialization_deadline) {
+				std::printf("%-40s initialization failed\n", name);
+				std::abort();
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		// the handler polls in the background, the measuring thread only sleeps
+		std::this_thread::sleep_for(measurement_time);
+
+		const std::uint64_t polls_before = device.get_polls_count();
+		const std::uint64_t allocations_before = allocations_count.load(std::memory_order_relaxed);
+		const clock::time_point start_time = clock::now();
+
+		std::this_thread::sleep_for(measurement_time);
+
+		const clock::duration duration = clock::now() - start_time;
+		const std::uint64_t allocations = allocations_count.load(std::memory_order_relaxed) - allocations_before;
+		const std::uint64_t polls = std::max<std::uint64_t>(device.get_polls_count() - polls_before, 1);
+
+		std::printf("%-40s %12.1f ns/op %10.2f allocs/op\n", name,
+			(double)std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / polls,
+			(double)allocations / polls);
+	}
+}
+
+frame make_bill_table() {
+	// RUB 10, 50, 100, 500, 1000, 5000
+	const std::uint8_t records[][5] = {
+		{ 1, 'R', 'U', 'S', 1 },
+		{ 5, 'R', 'U', 'S', 1 },
+		{ 1, 'R', 'U', 'S', 2 },
+		{ 5, 'R', 'U', 'S', 2 },
+		{ 1, 'R', 'U', 'S', 3 },
+		{ 5, 'R', 'U', 'S', 3 }
+	};
+
+	frame bill_table(24 * 5);
+	for (std::size_t i = 0; i < sizeof(records) / sizeof(records[0]); ++i) {
+		std::copy(records[i], records[i] + 5, bill_table.data() + i * 5);
+	}
+
+	return bill_table;
+}
+
+int main() {
+	const frame bill_table = make_bill_table();
+	const bill_table_index bill_types(decode_bill_table(bill_table));
+	const std::uint8_t status_data[] = { 0x00, 0x00, 0x3f, 0x00, 0x00, 0x00 };
+	const frame status(status_data, status_data + sizeof(status_data));
+	const std::uint8_t enable_bill_types_data[] = { 0x00, 0x00, 0x3f, 0x00, 0x00, 0x3f };
+
+	frame poll_frame;
+	encode_frame(poll_frame, device_address, poll_command, nullptr, 0);
+	frame poll_response_frame;
+	encode_frame(poll_response_frame, device_address, idling_state, nullptr, 0);
+	frame bill_table_frame;
+	encode_frame(bill_table_frame, device_address, bill_table[0], bill_table.data() + 1, bill_table.size() - 1);
+
+	run_benchmark("get_crc/poll", [&poll_frame]() {
+		sink += crc16_engine::compute(poll_frame.data(), poll_frame.size() - sizeof(std::uint16_t));
+	});
+
+	run_benchmark("get_crc/bill_table", [&bill_table_frame]() {
+		sink += crc16_engine::compute(bill_table_frame.data(), bill_table_frame.size() - sizeof(std::uint16_t));
+	});
+
+	run_benchmark("build_command_frame/poll", []() {
+		frame command_frame;
+		encode_frame(command_frame, device_address, poll_command, nullptr, 0);
+		sink += command_frame[command_frame.size() - 1];
+	});
+
+	run_benchmark("build_command_frame/enable_bill_types", [&enable_bill_types_data]() {
+		frame command_frame;
+		encode_frame(command_frame, device_address, enable_bill_types_command, enable_bill_types_data, sizeof(enable_bill_types_data));
+		sink += command_frame[command_frame.size() - 1];
+	});
+
+	frame_parser parser;
+	frame parsed_frame;
+
+	run_benchmark("parse_frame/poll_response", [&parser, &parsed_frame, &poll_response_frame]() {
+		receive(parser, poll_response_frame);
+		sink += (std::uint64_t)parser.parse(parsed_frame);
+	});
+
+	run_benchmark("parse_frame/bill_table", [&parser, &parsed_frame, &bill_table_frame]() {
+		receive(parser, bill_table_frame);
+		sink += (std::uint64_t)parser.parse(parsed_frame);
+	});
+
+	run_benchmark("decode_bill_table", [&bill_table]() {
+		sink += decode_bill_table(bill_table).size();
+	});
+
+	run_benchmark("decode_enabled_bill_types", [&status, &bill_types]() {
+		sink += decode_enabled_bill_types(status, bill_types).size();
+	});
+
+	run_poll_round_trip_benchmark("round_trip/poll");
+
+	return EXIT_SUCCESS;
+}
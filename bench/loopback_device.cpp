@@ -0,0 +1,88 @@
+#include "loopback_device.h"
+#include <algorithm>
+#include "protocol.h"
+
+using namespace ccnet;
+
+const std::uint8_t reset_command = 0x30;
+const std::uint8_t get_status_command = 0x31;
+const std::uint8_t poll_command = 0x33;
+const std::uint8_t identification_command = 0x37;
+const std::uint8_t get_bill_table_command = 0x41;
+const std::uint8_t download_command = 0x50;
+const std::uint8_t get_crc32_command = 0x51;
+const std::uint8_t request_statistics_command = 0x60;
+
+const std::uint8_t idling_state = 0x14;
+
+const std::size_t status_size = 6;
+const std::size_t identification_size = 34;
+const std::size_t bill_types_count = 24;
+const std::size_t bill_type_size = 5;
+
+// RUB 10, 50, 100, 500, 1000, 5000
+const std::uint8_t bill_types[][bill_type_size] = {
+	{ 1, 'R', 'U', 'S', 1 },
+	{ 5, 'R', 'U', 'S', 1 },
+	{ 1, 'R', 'U', 'S', 2 },
+	{ 5, 'R', 'U', 'S', 2 },
+	{ 1, 'R', 'U', 'S', 3 },
+	{ 5, 'R', 'U', 'S', 3 }
+};
+
+loopback_device::loopback_device() :
+	polls_count(0) { }
+
+void loopback_device::respond(const frame& written_frame, frame& response) {
+	const std::uint8_t device_address = written_frame[adr_offset];
+	const std::uint8_t code = written_frame[header_size];
+
+	switch (code) {
+		case ack:
+		case nak: {
+			// the confirmations of the host are not answered
+			break;
+		}
+		case poll_command: {
+			this->polls_count.fetch_add(1, std::memory_order_relaxed);
+			encode_frame(response, device_address, idling_state, nullptr, 0);
+			break;
+		}
+		case get_status_command: {
+			const std::uint8_t status[status_size] = {};
+			encode_frame(response, device_address, status[0], status + 1, status_size - 1);
+			break;
+		}
+		case identification_command: {
+			std::uint8_t identification[identification_size] = {};
+			const char part_and_serial_number[] = "SM-RU1353      41K000000001";
+			std::copy_n(part_and_serial_number, sizeof(part_and_serial_number) - 1, identification);
+			encode_frame(response, device_address, identification[0], identification + 1, identification_size - 1);
+			break;
+		}
+		case get_bill_table_command: {
+			std::uint8_t bill_table[bill_types_count * bill_type_size] = {};
+			for (std::size_t i = 0; i < sizeof(bill_types) / sizeof(bill_types[0]); ++i) {
+				std::copy_n(bill_types[i], bill_type_size, bill_table + i * bill_type_size);
+			}
+			encode_frame(response, device_address, bill_table[0], bill_table + 1, sizeof(bill_table) - 1);
+			break;
+		}
+		case download_command:
+		case get_crc32_command:
+		case request_statistics_command: {
+			encode_frame(response, device_address, ill_cmd, nullptr, 0);
+			break;
+		}
+		case reset_command:
+		default: {
+			// the configuration and the escrow commands
+			encode_frame(response, device_address, ack, nullptr, 0);
+			break;
+		}
+	}
+}
+
+std::uint64_t loopback_device::get_polls_count() const {
+	return this->polls_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,32 @@
+#ifndef CCNET_LOOPBACK_DEVICE_H
+#define CCNET_LOOPBACK_DEVICE_H
+
+#include <atomic>
+#include <cstdint>
+#include "frame.h"
+
+namespace ccnet {
+
+	// a bill validator idling on an in-memory line (see loopback_transport):
+	// it answers the initialization of the handler with a fixed identity and bill table,
+	// acknowledges the configuration and reports idling to every poll
+	class loopback_device {
+		public:
+			loopback_device();
+
+			loopback_device(const loopback_device& other) = delete;
+
+			loopback_device& operator=(const loopback_device& other) = delete;
+
+			// answers the frame written by the host, called on the thread of the handler
+			void respond(const frame& written_frame, frame& response);
+			// the poll commands answered so far, read from any thread
+			std::uint64_t get_polls_count() const;
+
+		private:
+			std::atomic<std::uint64_t> polls_count;
+	};
+
+}
+
+#endif // CCNET_LOOPBACK_DEVICE_H
@@ -0,0 +1,50 @@
+#include "loopback_transport.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace boost::asio;
+using namespace ccnet;
+
+loopback_transport::loopback_transport(const responder& device_responder) :
+	device_responder(device_responder),
+	written_frame(),
+	response(),
+	read_offset(0) {
+	if (!device_responder) {
+		throw std::runtime_error("invalid arguments");
+	}
+}
+
+void loopback_transport::set_options(const connection_options& options) { }
+
+void loopback_transport::set_baud_rate(std::uint32_t baud_rate) { }
+
+bool loopback_transport::write(const const_buffer& data, clock::duration timeout) {
+	const std::size_t size = buffer_size(data);
+	if (size > frame::capacity) {
+		throw std::runtime_error("frame is too long");
+	}
+
+	// the host writes a frame at a time
+	this->written_frame.clear();
+	this->written_frame.append(buffer_cast<const std::uint8_t*>(data), size);
+
+	this->response.clear();
+	this->read_offset = 0;
+	this->device_responder(this->written_frame, this->response);
+
+	return true;
+}
+
+std::size_t loopback_transport::read_some(const mutable_buffer& data, clock::duration timeout) {
+	const std::size_t size = std::min(buffer_size(data), this->response.size() - this->read_offset);
+
+	std::copy_n(this->response.data() + this->read_offset, size, buffer_cast<std::uint8_t*>(data));
+	this->read_offset += size;
+
+	return size;
+}
+
+void loopback_transport::discard_input() {
+	this->read_offset = this->response.size();
+}
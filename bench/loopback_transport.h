@@ -0,0 +1,43 @@
+#ifndef CCNET_LOOPBACK_TRANSPORT_H
+#define CCNET_LOOPBACK_TRANSPORT_H
+
+#include <cstdint>
+#include <functional>
+#include "frame.h"
+#include "serial_transport.h"
+
+namespace ccnet {
+
+	// an in-memory line answered by a function on the thread writing the frames,
+	// so the tests and the benchmarks drive a bill validator without a device;
+	// the response is available as soon as the command is written, the reads never wait
+	class loopback_transport : public serial_transport {
+		public:
+			// fills the response to the frame written by the host,
+			// leaves it empty for the frames the device does not answer (the confirmations)
+			typedef std::function<void(const frame& written_frame, frame& response)> responder;
+
+			explicit loopback_transport(const responder& device_responder);
+
+			loopback_transport(const loopback_transport& other) = delete;
+
+			loopback_transport& operator=(const loopback_transport& other) = delete;
+
+			void set_options(const connection_options& options) override;
+			void set_baud_rate(std::uint32_t baud_rate) override;
+
+			bool write(const boost::asio::const_buffer& data, clock::duration timeout) override;
+			std::size_t read_some(const boost::asio::mutable_buffer& data, clock::duration timeout) override;
+			void discard_input() override;
+
+		private:
+			responder device_responder;
+			frame written_frame;
+			// the response bytes not read yet
+			frame response;
+			std::size_t read_offset;
+	};
+
+}
+
+#endif // CCNET_LOOPBACK_TRANSPORT_H
@@ -0,0 +1,49 @@
+#ifndef CCNET_BILL_TABLE_CACHE_H
+#define CCNET_BILL_TABLE_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include "cash_type.h"
+
+namespace ccnet {
+
+	// the bill tables of the devices kept in a file across the restarts,
+	// keyed by the serial number and the CRC32 of the firmware the table has been read from;
+	// a cache may be shared by the bill validators of several lines,
+	// the lookups and the updates are synchronised
+	class bill_table_cache {
+		public:
+			// reads the file if it exists,
+			// a damaged file is ignored and replaced on the next update
+			explicit bill_table_cache(const std::string& path);
+
+			bill_table_cache(const bill_table_cache& other) = delete;
+
+			bill_table_cache& operator=(const bill_table_cache& other) = delete;
+
+			// returns false if the table of the device running the firmware is not cached
+			bool find_bill_table(const std::string& serial_number, std::uint32_t firmware_crc32, std::map<std::uint8_t, cash_type>& bill_table) const;
+			// replaces the table of the device and rewrites the file,
+			// the tables of the previous firmware of the device are dropped
+			void store_bill_table(const std::string& serial_number, std::uint32_t firmware_crc32, const std::map<std::uint8_t, cash_type>& bill_table);
+
+		private:
+			typedef std::pair<std::string, std::uint32_t> entry_key;
+
+		private:
+			// writes a temporary file and renames it over the cache,
+			// so a crash leaves either the previous or the new cache
+			void save() const;
+
+		private:
+			std::string path;
+			mutable std::mutex entries_mutex;
+			std::map<entry_key, std::map<std::uint8_t, cash_type>> entries;
+	};
+
+}
+
+#endif // CCNET_BILL_TABLE_CACHE_H
@@ -1,19 +1,56 @@
 #ifndef CCNET_BILL_VALIDATOR_H
 #define CCNET_BILL_VALIDATOR_H
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <map>
-#include <queue>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <set>
+#include <stdexcept>
 #include <string>
-#include <thread>
-#include <boost/asio.hpp>
+#include <type_traits>
+#include <utility>
+#include "bill_table_cache.h"
+#include "bus_manager.h"
 #include "ccnet.h"
+#include "connection_options.h"
+#include "device_counters.h"
+#include "device_snapshot.h"
+#include "device_statistics.h"
+#include "escrow_policy.h"
+#include "firmware_update.h"
+#include "host_request.h"
+#include "poll_policy.h"
+#include "transaction_journal.h"
 
 namespace ccnet {
 
+	class bill_table_index;
+	class block_pool;
+	class bus;
+	class firmware_image;
+	class frame;
+	class statistics_recorder;
+	struct statistics_report;
+
+	template<typename T>
+	class mpsc_queue;
+
 	class bill_validator {
 		public:
-			bill_validator(const std::string& port_name, bill_validator_operator* bill_validator_operator);
+			static const std::uint8_t default_device_address = 0x03;
+
+			// connects to the bill validator using a dedicated bus manager;
+			// the money events are written to the journal if one is specified,
+			// the bill table is taken from the cache if one is specified and the device runs the same firmware
+			bill_validator(const std::string& port_name, bill_validator_operator* bill_validator_operator, const poll_policy& policy = poll_policy(), const escrow_policy& escrow = escrow_policy(), const connection_options& options = connection_options(), transaction_journal* journal = nullptr, bill_table_cache* cache = nullptr);
+			// connects to the bill validator with the specified address
+			// on a serial line driven by the bus manager
+			bill_validator(bus_manager& manager, const std::string& port_name, std::uint8_t device_address, bill_validator_operator* bill_validator_operator, const poll_policy& policy = poll_policy(), const escrow_policy& escrow = escrow_policy(), const connection_options& options = connection_options(), transaction_journal* journal = nullptr, bill_table_cache* cache = nullptr);
 
 			bill_validator(const bill_validator& other) = delete;
 			//bill_validator(bill_validator&& other);
@@ -28,37 +65,105 @@ namespace ccnet {
 			std::future<std::map<cash_type, bill_security_level>> get_cash_types_security_levels();
 			std::future<void> set_cash_types_security_levels(const std::map<cash_type, bill_security_level>& security_levels);
 			std::future<std::set<cash_type>> get_cash_types();
+			// downloads the firmware image from the file with DOWNLOAD unless the CRC32 of the device already matches it,
+			// the boot loader verifies the image and the device is reinitialized;
+			// the download starts in the power up, initialization, failure or unit disabled states only,
+			// after a failed one the device stays in the boot loader, neither polled nor reset,
+			// and the other requests fail until the download is retried and succeeds;
+			// the device is not polled during the download while the other devices of the line are,
+			// the devices on different lines of a bus manager with several workers are updated in parallel
+			std::future<firmware_update_result> update_firmware(const std::string& image_path, const firmware_progress_handler& progress_handler = firmware_progress_handler());
 
-		private:
-			typedef std::vector<std::uint8_t> frame;
-			typedef std::uint16_t crc16;
-
-			enum class device_state_code : std::uint8_t {
-				unknown = 0x00,
-				power_up = 0x10,
-				power_up_with_bill_in_val = 0x11,
-				power_up_with_bill_in_stack = 0x12,
-				initialize = 0x13,
-				idling = 0x14,
-				accepting = 0x15,
-				stacking = 0x17,
-				returning = 0x18,
-				unit_disabled = 0x19,
-				holding = 0x1a,
-				device_busy = 0x1b,
-				rejecting = 0x1c,
-				drop_cassette_full = 0x41,
-				drop_cassette_out_of_pos = 0x42,
-				validator_jammed = 0x43,
-				drop_cassette_jammed = 0x44,
-				cheated = 0x45,
-				pause = 0x46,
-				failure = 0x47,
-				escrow_pos = 0x80,
-				bill_stacked = 0x81,
-				bill_returned = 0x82
-			};
+			// the asynchronous counterparts of the operations above completed through an Asio completion token
+			// (a callback, boost::asio::use_awaitable, boost::asio::use_future, ...)
+			// with the signature void(std::exception_ptr, result) or void(std::exception_ptr);
+			// the handler is invoked on its associated executor, no thread waits for the result
+			template<typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, void(std::exception_ptr, device_info))
+			async_get_device_info(CompletionToken&& token) {
+				return this->async_request<device_info>(handler_command_code::get_device_info, handler_command_data(), 0, std::exception_ptr(), std::forward<CompletionToken>(token));
+			}
+
+			template<typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, void(std::exception_ptr, std::set<cash_type>))
+			async_get_enabled_cash_types(CompletionToken&& token) {
+				return this->async_request<std::set<cash_type>>(handler_command_code::get_enabled_bill_types, handler_command_data(), 0, std::exception_ptr(), std::forward<CompletionToken>(token));
+			}
+
+			template<typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, void(std::exception_ptr))
+			async_set_enabled_cash_types(const std::set<cash_type>& enabled_cash_types, CompletionToken&& token) {
+				handler_command_data command_data = {};
+				std::exception_ptr error;
+
+				try {
+					this->encode_enabled_cash_types(enabled_cash_types, command_data);
+				} catch (std::exception) {
+					error = std::current_exception();
+				}
+
+				return this->async_request<void>(handler_command_code::set_enabled_bill_types, command_data, enable_bill_types_command_data_size, error, std::forward<CompletionToken>(token));
+			}
+
+			template<typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, void(std::exception_ptr, std::map<cash_type, bill_security_level>))
+			async_get_cash_types_security_levels(CompletionToken&& token) {
+				return this->async_request<std::map<cash_type, bill_security_level>>(handler_command_code::get_bill_types_security_levels, handler_command_data(), 0, std::exception_ptr(), std::forward<CompletionToken>(token));
+			}
+
+			template<typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, void(std::exception_ptr))
+			async_set_cash_types_security_levels(const std::map<cash_type, bill_security_level>& security_levels, CompletionToken&& token) {
+				handler_command_data command_data = {};
+				std::exception_ptr error;
+
+				try {
+					this->encode_cash_types_security_levels(security_levels, command_data);
+				} catch (std::exception) {
+					error = std::current_exception();
+				}
+
+				return this->async_request<void>(handler_command_code::set_bill_types_security_levels, command_data, set_security_command_data_size, error, std::forward<CompletionToken>(token));
+			}
+
+			template<typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, void(std::exception_ptr, std::set<cash_type>))
+			async_get_cash_types(CompletionToken&& token) {
+				return this->async_request<std::set<cash_type>>(handler_command_code::get_bill_types, handler_command_data(), 0, std::exception_ptr(), std::forward<CompletionToken>(token));
+			}
+
+			template<typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, void(std::exception_ptr, firmware_update_result))
+			async_update_firmware(const std::string& image_path, const firmware_progress_handler& progress_handler, CompletionToken&& token) {
+				std::shared_ptr<const firmware_image> image;
+				std::exception_ptr error;
+
+				try {
+					image = open_firmware_image(image_path, progress_handler);
+				} catch (std::exception) {
+					error = std::current_exception();
+				}
+
+				return this->async_request<firmware_update_result>(handler_command_code::update_firmware, handler_command_data(), 0, image, error, std::forward<CompletionToken>(token));
+			}
+
+			// the device state published by the handler,
+			// read from any thread without waiting for the handler
+			std::shared_ptr<const device_snapshot> get_snapshot() const;
+			// the measured number of poll commands per second
+			double get_poll_rate() const;
+			// the protocol counters and the command latencies,
+			// taken without waiting for the exchange in progress
+			device_statistics get_statistics() const;
+			// the change of the counters kept by the device since the previous call,
+			// collected in the background by REQUEST STATISTICS (see poll_policy::statistics_interval);
+			// the first call returns all the counters the device keeps, as after a reset of its statistics
+			device_counters take_device_counters();
+			// the time the status read by GET STATUS is reused for the following requests,
+			// zero makes only the requests waiting together share the status
+			void set_status_cache_ttl(std::chrono::milliseconds ttl);
 
+		private:
 			typedef std::uint8_t device_state_info;
 
 			//enum class device_state_info : std::uint8_t {
@@ -121,12 +226,15 @@ namespace ccnet {
 			};
 
 			struct device_command {
-				device_command(device_command_code code, const std::vector<std::uint8_t>& data) :
+				device_command(device_command_code code, const std::uint8_t* data = nullptr, std::size_t data_size = 0) :
 					code(code),
-					data(data) { }
+					data(data),
+					data_size(data_size) { }
 
 				device_command_code code;
-				std::vector<std::uint8_t> data;
+				// the data is not owned by the command
+				const std::uint8_t* data;
+				std::size_t data_size;
 			};
 
 			enum class handler_command_code : std::uint8_t {
@@ -135,68 +243,306 @@ namespace ccnet {
 				get_device_info,
 				get_enabled_bill_types,
 				set_bill_types_security_levels,
-				set_enabled_bill_types
+				set_enabled_bill_types,
+				update_firmware
 			};
 
+			// the longest data passed with a handler command
+			static const std::size_t handler_command_data_size_max = 6;
+			typedef std::array<std::uint8_t, handler_command_data_size_max> handler_command_data;
+			// the size of the GET STATUS response data kept in the cache
+			static const std::size_t status_result_data_size = 6;
+
 			struct handler_command {
-				handler_command(handler_command_code code, const std::vector<std::uint8_t>& data, void* result) :
+				handler_command() :
+					code(),
+					data(),
+					data_size(0),
+					result(nullptr),
+					push_time(),
+					image() { }
+
+				handler_command(handler_command_code code, const std::uint8_t* data, std::size_t data_size, request* result, std::shared_ptr<const firmware_image> image = nullptr) :
 					code(code),
-					data(data),
-					result(result) { }
+					data(),
+					data_size(data_size),
+					result(result),
+					push_time(std::chrono::steady_clock::now()),
+					image(std::move(image)) {
+					std::copy(data, data + data_size, this->data.begin());
+				}
 
 				handler_command_code code;
-				std::vector<std::uint8_t> data;
-				void* result;
+				handler_command_data data;
+				std::size_t data_size;
+				request* result;
+				std::chrono::steady_clock::time_point push_time;
+				// the image to download, too large to be passed as the data
+				std::shared_ptr<const firmware_image> image;
 			};
 
 		private:
-			void operate();
+			friend class bus;
+
+			void attach(const std::string& port_name, const connection_options& options);
+			// runs a single iteration of the device handling,
+			// returns the time of the next one
+			std::chrono::steady_clock::time_point step();
+			// starts an asynchronous request once the completion handler is known
+			template<typename T>
+			class request_initiation {
+				public:
+					request_initiation(bill_validator* device, handler_command_code code) :
+						device(device),
+						code(code) { }
+
+					template<typename Handler>
+					void operator()(Handler&& handler, const handler_command_data& data, std::size_t data_size, std::shared_ptr<const firmware_image> image, std::exception_ptr error) const {
+						this->device->template push_handler_request<T>(this->code, data.data(), data_size, std::move(image), error, std::forward<Handler>(handler));
+					}
+
+				private:
+					bill_validator* device;
+					handler_command_code code;
+			};
+
+			template<typename T, typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, typename request_completion_signature<T>::type)
+			async_request(handler_command_code code, const handler_command_data& data, std::size_t data_size, std::exception_ptr error, CompletionToken&& token) {
+				return this->async_request<T>(code, data, data_size, std::shared_ptr<const firmware_image>(), error, std::forward<CompletionToken>(token));
+			}
+
+			template<typename T, typename CompletionToken>
+			BOOST_ASIO_INITFN_RESULT_TYPE(CompletionToken, typename request_completion_signature<T>::type)
+			async_request(handler_command_code code, const handler_command_data& data, std::size_t data_size, std::shared_ptr<const firmware_image> image, std::exception_ptr error, CompletionToken&& token) {
+				return boost::asio::async_initiate<CompletionToken, typename request_completion_signature<T>::type>(
+					request_initiation<T>(this, code), token, data, data_size, std::move(image), error);
+			}
+
+			// creates a request completing the handler and queues the command to fulfil it,
+			// the errors are passed to the handler
+			template<typename T, typename Handler>
+			void push_handler_request(handler_command_code code, const std::uint8_t* data, std::size_t data_size, std::shared_ptr<const firmware_image> image, std::exception_ptr error, Handler&& handler) {
+				typedef handler_request<T, typename std::decay<Handler>::type> request_type;
+
+				request_type* pending_request = new (this->allocate_request(sizeof(request_type))) request_type(std::forward<Handler>(handler));
+
+				if (error) {
+					pending_request->fail(error);
+					this->release_request(pending_request);
+					return;
+				}
+
+				handler_command new_command(code, data, data_size, pending_request, std::move(image));
+
+				if (!this->push_command(new_command)) {
+					pending_request->fail(std::make_exception_ptr(std::runtime_error("command queue is full")));
+					this->release_request(pending_request);
+				}
+			}
+
+			// creates a pooled request and queues the command to fulfil it
+			template<typename T>
+			std::future<T> push_request(handler_command_code code, const std::uint8_t* data, std::size_t data_size, std::shared_ptr<const firmware_image> image = nullptr);
+			// maps the image file and computes its CRC32 on the calling thread
+			static std::shared_ptr<const firmware_image> open_firmware_image(const std::string& image_path, const firmware_progress_handler& progress_handler);
+			// takes the memory from the pool or from the heap if the pool is exhausted
+			void* allocate_request(std::size_t size);
+			void release_request(request* pending_request);
+			// throw if a cash type is not in the bill table
+			void encode_enabled_cash_types(const std::set<cash_type>& enabled_cash_types, handler_command_data& command_data) const;
+			void encode_cash_types_security_levels(const std::map<cash_type, bill_security_level>& security_levels, handler_command_data& command_data) const;
+			// queues the command and wakes up the handler,
+			// returns false if the queue is full
+			bool push_command(handler_command& command);
+			bool has_pending_commands() const;
+			// processes the next queued command if any
+			void process_command();
+			void initialize();
+			// whether the device has kept its configuration and may go on without a reset
+			// after the drop cassette has been inserted
+			static bool is_operational_state(device_state_code code);
+			// whether the device accepts IDENTIFICATION, GET BILL TABLE, DOWNLOAD, GET CRC32 and REQUEST STATISTICS:
+			// power up, initialization, the failures and unit disabled, it answers ILLEGAL COMMAND otherwise
+			static bool is_service_state(device_state_code code);
+			// compares the configuration set by the host with GET STATUS
+			// and sends again only the masks the device has lost
+			void restore_configuration();
+			// publishes the index of the bill table if it has changed,
+			// the configuration set by the host for the previous table is forgotten
+			void replace_bill_table(const std::map<std::uint8_t, cash_type>& bill_table);
+			// tries the candidate baud rates from the fastest one with POLL
+			// and locks the line to the first rate the device answers at
+			void detect_baud_rate();
+			// sends POLL at the current rate, returns false if no valid frame has been received;
+			// any frame passing the CRC check proves the rate, ILLEGAL COMMAND included,
+			// so the device is found whatever state it is in
+			bool probe_baud_rate();
+			// runs the hooks of the change of the state code from the transition table;
+			// a hook returning false only ends the dispatch,
+			// the one requiring the reinitialization sets initialization_required as well
+			void dispatch_state_transition();
+			// the state hooks and the transition actions,
+			// return false to skip the following handlers of the transition
+			bool enter_power_up();
+			bool enter_power_up_with_bill();
+			bool enter_drop_cassette_full();
+			bool enter_drop_cassette_out_of_pos();
+			bool exit_drop_cassette_out_of_pos();
+			bool enter_escrow_pos();
+			bool enter_bill_stacked();
+			bool enter_bill_returned();
+			// the bill held for the operator is back in escrow, it is not a new bill
+			bool resume_escrow();
+			// appends the event to the journal if there is one,
+			// the bill events carry the cash type of the bill type in the state info;
+			// a failing journal is counted in the statistics and does not stop the polling
+			void record_journal_event(journal_event event, const device_state& state);
+			// replaces the published snapshot with the current device state
+			void publish_snapshot(bool is_initialized);
 			void reset();
 			device_state poll();
 			void stack_bill();
 			void return_bill();
 			device_info request_device_info();
 			void hold_bill();
+			// asks the operator what to do with the bill in escrow without waiting for the answer
+			void request_escrow_decision();
+			// carries out the decision if it has arrived or is overdue,
+			// keeps the bill held otherwise
+			void process_escrow_decision();
 			std::map<std::uint8_t, cash_type> request_bill_table();
-			void get_bill_types_handler(const std::vector<std::uint8_t>& data, void* untyped_result);
-			void get_device_info_handler(const std::vector<std::uint8_t>& data, void* untyped_result);
-			void get_enabled_bill_types_handler(const std::vector<std::uint8_t>& data, void* untyped_result);
-			void set_enabled_bill_types_handler(const std::vector<std::uint8_t>& data, void* untyped_result);
-			void get_bill_types_security_levels_handler(const std::vector<std::uint8_t>& data, void* untyped_result);
-			void set_bill_types_security_levels_handler(const std::vector<std::uint8_t>& data, void* untyped_result);
+			// takes the bill table from the cache if the device runs the firmware it has been read from,
+			// reads it with GET BILL TABLE and caches it otherwise
+			std::map<std::uint8_t, cash_type> request_cached_bill_table();
+			// reads the bill table again and replaces the cached one if the device has another table;
+			// the table is read once, the reinitialization following a lost connection asks for it again
+			void revalidate_bill_table();
+			void store_cached_bill_table(const std::map<std::uint8_t, cash_type>& bill_table);
+			// reads the status with GET STATUS unless the cached one is still fresh
+			// for a command pushed at the specified time
+			void request_status(std::chrono::steady_clock::time_point push_time, frame& status);
+			void invalidate_status();
+			void get_bill_types_handler(const frame& data, request* untyped_result);
+			void get_device_info_handler(const frame& data, request* untyped_result);
+			void get_enabled_bill_types_handler(std::chrono::steady_clock::time_point push_time, request* untyped_result);
+			void set_enabled_bill_types_handler(const frame& data, request* untyped_result);
+			void get_bill_types_security_levels_handler(std::chrono::steady_clock::time_point push_time, request* untyped_result);
+			void set_bill_types_security_levels_handler(const frame& data, request* untyped_result);
+			// starts the download unless the device already runs the image
+			void update_firmware_handler(std::shared_ptr<const firmware_image> image, request* untyped_result);
+			// starts the boot loader unless it already runs and reads the block size it writes
+			void enter_download_mode();
+			// sends a DOWNLOAD subcommand answered with the boot loader status
+			std::uint8_t send_download_subcommand(std::uint8_t subcommand);
+			// writes the next block of the image being downloaded,
+			// leaves the boot loader and completes the update after the last one
+			void download_firmware_block();
+			std::uint32_t request_firmware_crc32();
+			// whether a service command may be sent in the poll slot: the device is in a service state,
+			// no bill is waiting for a decision and no host command is pending
+			bool is_service_slot() const;
+			bool is_statistics_due(std::chrono::steady_clock::time_point poll_time) const;
+			// reads the device counters with REQUEST STATISTICS and publishes them,
+			// damaged statistics reported by the device are skipped
+			// and a device rejecting the command is not asked for them again
+			void collect_statistics();
 			std::uint16_t read_uint16(const frame& frame) const;
 			std::uint64_t read_uint64(const frame& frame) const;
-			void write_uint16(frame& frame, std::uint16_t value) const;
 
 			// constructs a frame
 			// from a command, command data and service data
 			// and adds the frame check sequence to the frame
-			frame build_command_frame(const device_command& command) const;
+			void build_command_frame(const device_command& command, frame& command_frame) const;
 
 			// accesses the bill validator
 			// to process a command with an expected result
-			std::vector<std::uint8_t> get_command_result(const device_command& command);
+			void get_command_result(const device_command& command, frame& payload);
+			// the same for the command frames and the payloads which may be extended frames
+			template<typename CommandFrame, typename Payload>
+			void get_command_result(device_command_code code, const CommandFrame& command_frame, Payload& payload);
 			// accesses the bill validator
 			// to process a command without an expected result
 			void send_command(const device_command& command);
-
-			crc16 get_crc(const frame& frame) const;
-			void send_ack(std::uint8_t device_address);
-			void send_nak(std::uint8_t device_address);
+			// waits for the acknowledgement longer than t-response
+			void send_command(const device_command& command, std::chrono::milliseconds response_timeout);
+			// records the time since the command has been sent first
+			void record_latency(device_command_code code, std::chrono::steady_clock::time_point start_time);
 
 		private:
-			std::thread cmd_handler_thread;
-			bool thread_is_working;
-			std::queue<handler_command> cmd_queue;
-			std::mutex cmd_queue_mutex;
-			boost::asio::io_service io_service;
-			boost::asio::serial_port serial_port;
+			// the manager created for a standalone bill validator
+			std::unique_ptr<bus_manager> owned_bus_manager;
+			bus_manager* device_bus_manager;
+			bus* device_bus;
+			const std::uint8_t device_address;
+			// memory for the pending requests and their future shared states
+			std::shared_ptr<block_pool> request_blocks;
+			std::unique_ptr<mpsc_queue<handler_command>> cmd_queue;
+			std::unique_ptr<statistics_recorder> device_statistics_recorder;
 			bill_validator_operator* connected_device_operator;
+			const poll_policy device_poll_policy;
+			const escrow_policy device_escrow_policy;
+			transaction_journal* journal;
+			bill_table_cache* cache;
+			// exponentially smoothed interval between two poll commands in microseconds
+			std::atomic<std::int64_t> average_poll_interval;
+			bool initialization_required;
+			device_state previous_device_state;
+			device_state current_device_state;
+			std::chrono::steady_clock::time_point previous_poll_time;
+			std::chrono::steady_clock::time_point next_poll_time;
+			// valid while the operator decides on the bill in escrow
+			std::future<cash_action> escrow_decision;
+			std::uint8_t escrow_bill_type_number;
+			std::chrono::steady_clock::time_point escrow_decision_deadline;
+			std::chrono::steady_clock::time_point next_hold_time;
 			device_info connected_device_info;
-			std::map<std::uint8_t, cash_type> bill_types_by_numbers;
+			// replaced on the reinitialization,
+			// accessed with the atomic shared pointer functions from the caller threads
+			std::shared_ptr<const bill_table_index> bill_types_index;
+			// the CRC32 of the firmware the bill table has been cached for
+			std::uint32_t firmware_crc32;
+			// the bill table has been taken from the cache and is to be read in an idle poll slot
+			bool bill_table_revalidation_required;
+			// the last masks sent by the host, restored when the device has lost them
+			handler_command_data desired_enabled_bill_types;
+			bool has_desired_enabled_bill_types;
+			handler_command_data desired_security_levels;
+			bool has_desired_security_levels;
+			// the configuration is to be checked as soon as the device rests
+			bool configuration_restore_required;
+			// accessed with the atomic shared pointer functions only
+			std::shared_ptr<const device_snapshot> published_snapshot;
+			// in milliseconds
+			std::atomic<std::int64_t> status_cache_ttl;
+			bool is_status_cached;
+			std::array<std::uint8_t, status_result_data_size> cached_status;
+			// the time the cached status has been received
+			std::chrono::steady_clock::time_point status_time;
+			// the image being downloaded, the device is not polled until the download is over
+			std::shared_ptr<const firmware_image> downloaded_image;
+			// the offset of the next block to download
+			std::size_t downloaded_size;
+			request* firmware_result;
+			// the boot loader runs until an image has been downloaded,
+			// it answers nothing but the DOWNLOAD subcommands
+			bool download_mode_entered;
+			// the size of the blocks the boot loader writes
+			std::size_t download_block_size;
+			std::chrono::steady_clock::time_point next_statistics_time;
+			// cleared when the device answers REQUEST STATISTICS with ILLEGAL COMMAND
+			bool statistics_supported;
+			// the last statistics read from the device,
+			// accessed with the atomic shared pointer functions only
+			std::shared_ptr<const statistics_report> collected_report;
+			// the statistics the previous take_device_counters call has counted up to
+			std::mutex taken_report_mutex;
+			std::shared_ptr<const statistics_report> taken_report;
 
-			static const std::uint8_t bill_types_count_max = 24;
-			static const std::size_t bill_type_record_size = 5;
+			static const std::size_t cmd_queue_capacity = 64;
+			// a request object, its future shared state and its result
+			static const std::size_t request_blocks_per_request = 3;
+			static const std::size_t request_block_size = 128;
 
 			// command data sizes in bytes
 			static const std::size_t set_security_command_data_size = 3;
@@ -205,9 +551,8 @@ namespace ccnet {
 			// result data sizes in bytes
 			static const std::size_t poll_min_result_data_size = 1;
 			static const std::size_t poll_max_result_data_size = 2;
-			static const std::size_t get_bill_table_result_data_size = bill_types_count_max * bill_type_record_size;
 			static const std::size_t identification_result_data_size = 34;
-			static const std::size_t get_status_result_data_size = 6;
+			static const std::size_t get_crc32_result_data_size = 4;
 	};
 
 }
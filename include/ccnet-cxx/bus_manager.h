@@ -0,0 +1,73 @@
+#ifndef CCNET_BUS_MANAGER_H
+#define CCNET_BUS_MANAGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include "connection_options.h"
+
+namespace ccnet {
+
+	class bill_validator;
+	class block_pool;
+	class bus;
+
+	// drives the devices connected to any number of serial lines
+	// using a single I/O thread and a pool of worker threads;
+	// the devices attached to the same line are polled round-robin
+	class bus_manager {
+		public:
+			explicit bus_manager(std::size_t workers_count = 1);
+
+			bus_manager(const bus_manager& other) = delete;
+
+			~bus_manager();
+
+			bus_manager& operator=(const bus_manager& other) = delete;
+
+		private:
+			friend class bill_validator;
+
+			// opens the line on first use,
+			// the devices sharing the line have to be connected with the same options
+			void attach(const std::string& port_name, const connection_options& options, bill_validator* device);
+			void detach(bus* device_bus, bill_validator* device);
+			// wakes up the workers to process a queued host command
+			void notify();
+			void work();
+			// waits for the workers to release the bus before a device is attached or detached
+			void wait_idle(std::unique_lock<std::mutex>& lock, const bus* device_bus);
+			bool is_busy(const bus* device_bus) const;
+			// stops the workers and the I/O thread
+			void stop();
+
+		private:
+			boost::asio::io_service io_service;
+			boost::asio::executor_work_guard<boost::asio::io_service::executor_type> io_service_work;
+			std::thread io_thread;
+			std::vector<std::thread> workers;
+			std::map<std::string, std::unique_ptr<bus>> buses_by_port_names;
+			// the buses being processed by the workers,
+			// there are never more of them than workers
+			std::vector<bus*> busy_buses;
+			// the attachments and the detachments waiting for a bus to be released
+			std::size_t waiting_changes_count;
+			// guards the buses and the scheduling state
+			std::mutex scheduler_mutex;
+			std::condition_variable scheduler_condition;
+			bool is_working;
+			// a wakeup has been posted but not delivered yet
+			std::atomic<bool> wakeup_pending;
+			// memory for the posted wakeup handlers
+			std::shared_ptr<block_pool> wakeup_blocks;
+	};
+
+}
+
+#endif // CCNET_BUS_MANAGER_H
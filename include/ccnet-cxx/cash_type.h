@@ -1,20 +1,38 @@
 #ifndef CCNET_CASH_TYPE_H
 #define CCNET_CASH_TYPE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 
 namespace ccnet {
 
+	// a denomination of a currency;
+	// the three-letter currency code is packed into an integer, the first letter in the highest byte,
+	// so the cash types compare like their codes and are copied without allocations
 	struct cash_type {
-		cash_type(
-			const std::string& currency_code = "",
-			std::uint64_t denomination = 0
-		) :
-			currency_code(currency_code),
-			denomination(denomination) { }
-
-		std::string currency_code;
+		static const std::size_t currency_code_size = 3;
+
+		cash_type() :
+			denomination(0),
+			packed_currency_code(0) { }
+
+		cash_type(const std::string& currency_code, std::uint64_t denomination = 0) :
+			denomination(denomination),
+			packed_currency_code(pack_currency_code(currency_code)) { }
+
+		// throws if the code is not exactly three characters long
+		static std::uint32_t pack_currency_code(const std::string& currency_code);
+		static std::uint32_t pack_currency_code(const char* currency_code, std::size_t size);
+
+		std::string get_currency_code() const;
+		// throws if the code is not exactly three characters long
+		void set_currency_code(const std::string& currency_code);
+
+		// in the minor currency units
 		std::uint64_t denomination;
+		std::uint32_t packed_currency_code;
 	};
 
 	bool operator==(const cash_type& lhs, const cash_type& rhs);
@@ -26,4 +44,16 @@ namespace ccnet {
 
 }
 
+namespace std {
+
+	template<>
+	struct hash<ccnet::cash_type> {
+		std::size_t operator()(const ccnet::cash_type& value) const {
+			// the denomination is scattered by the golden ratio multiplier before mixing in the currency
+			return std::hash<std::uint64_t>()((value.denomination * 0x9e3779b97f4a7c15ull) ^ value.packed_currency_code);
+		}
+	};
+
+}
+
 #endif // CCNET_CASH_TYPE_H
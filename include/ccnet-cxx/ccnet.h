@@ -27,6 +27,33 @@ namespace ccnet {
 		high = 1
 	};
 
+	// the state reported by the bill validator in response to the poll command
+	enum class device_state_code : std::uint8_t {
+		unknown = 0x00,
+		power_up = 0x10,
+		power_up_with_bill_in_val = 0x11,
+		power_up_with_bill_in_stack = 0x12,
+		initialize = 0x13,
+		idling = 0x14,
+		accepting = 0x15,
+		stacking = 0x17,
+		returning = 0x18,
+		unit_disabled = 0x19,
+		holding = 0x1a,
+		device_busy = 0x1b,
+		rejecting = 0x1c,
+		drop_cassette_full = 0x41,
+		drop_cassette_out_of_pos = 0x42,
+		validator_jammed = 0x43,
+		drop_cassette_jammed = 0x44,
+		cheated = 0x45,
+		pause = 0x46,
+		failure = 0x47,
+		escrow_pos = 0x80,
+		bill_stacked = 0x81,
+		bill_returned = 0x82
+	};
+
 	enum class cash_action : std::uint8_t {
 		hold_cash = 1,
 		accept_cash = 2,
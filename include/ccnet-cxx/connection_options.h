@@ -0,0 +1,88 @@
+#ifndef CCNET_CONNECTION_OPTIONS_H
+#define CCNET_CONNECTION_OPTIONS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ccnet {
+
+	class serial_transport;
+
+	// the serial line parameters and the protocol timing;
+	// the devices sharing a line have to be connected with the same options
+	struct connection_options {
+		enum class parity_type : std::uint8_t {
+			none,
+			odd,
+			even
+		};
+
+		enum class stop_bits_type : std::uint8_t {
+			one,
+			one_point_five,
+			two
+		};
+
+		enum class transport_type : std::uint8_t {
+			// boost::asio::serial_port, available on every platform
+			asio,
+			// the tty driven directly with epoll in low latency mode, Linux only
+			linux_low_latency
+		};
+
+		typedef std::function<std::unique_ptr<serial_transport>(const std::string& port_name, const connection_options& options)> transport_factory;
+
+		connection_options(
+			std::uint32_t baud_rate = 9600,
+			std::uint8_t character_size = 8,
+			parity_type parity = parity_type::none,
+			stop_bits_type stop_bits = stop_bits_type::one,
+			std::chrono::milliseconds response_timeout = std::chrono::milliseconds(10),
+			std::chrono::milliseconds inter_byte_timeout = std::chrono::milliseconds(5),
+			std::chrono::milliseconds free_line_time = std::chrono::milliseconds(20),
+			std::chrono::milliseconds adapter_latency = std::chrono::milliseconds(20),
+			transport_type transport = transport_type::asio
+		) :
+			baud_rate(baud_rate),
+			character_size(character_size),
+			parity(parity),
+			stop_bits(stop_bits),
+			response_timeout(response_timeout),
+			inter_byte_timeout(inter_byte_timeout),
+			free_line_time(free_line_time),
+			adapter_latency(adapter_latency),
+			transport(transport),
+			probe_baud_rates(),
+			custom_transport() { }
+
+		std::uint32_t baud_rate;
+		std::uint8_t character_size;
+		parity_type parity;
+		stop_bits_type stop_bits;
+		// the maximum time the device takes to respond to a command (t-response)
+		std::chrono::milliseconds response_timeout;
+		// the maximum time between the bytes of a frame (t-inter-byte)
+		std::chrono::milliseconds inter_byte_timeout;
+		// the line silence between a confirmation and the next command (t-free)
+		std::chrono::milliseconds free_line_time;
+		// the delay added by buffering serial adapters (e.g. USB bridges)
+		std::chrono::milliseconds adapter_latency;
+		transport_type transport;
+		// the baud rates the device may use; if not empty, they are tried with POLL
+		// on the initialization and the fastest one the device answers is used instead of the baud rate above
+		std::vector<std::uint32_t> probe_baud_rates;
+		// opens the line instead of the transport backend above if set, e.g. with an in-memory line;
+		// the options of the devices sharing a line are told apart by whether they set it
+		transport_factory custom_transport;
+	};
+
+	bool operator==(const connection_options& lhs, const connection_options& rhs);
+	bool operator!=(const connection_options& lhs, const connection_options& rhs);
+
+}
+
+#endif // CCNET_CONNECTION_OPTIONS_H
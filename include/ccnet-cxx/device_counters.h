@@ -0,0 +1,75 @@
+#ifndef CCNET_DEVICE_COUNTERS_H
+#define CCNET_DEVICE_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "cash_type.h"
+
+namespace ccnet {
+
+	// the counters kept by the bill validator itself, read with REQUEST STATISTICS;
+	// the device adds them up in sets of 10000 inserted bills, the counters of a set are laid out here
+	struct device_counters {
+		static const std::size_t denominations_count = 20;
+
+		// the places of the jams in the order the device reports them
+		enum class jam_place : std::uint8_t {
+			drop_cassette,
+			entrance,
+			entrance_and_aligning,
+			aligning,
+			aligning_and_optical,
+			optical,
+			optical_and_exit,
+			exit
+		};
+
+		static const std::size_t jam_places_count = 8;
+
+		device_counters() :
+			bills_inserted_count(0),
+			bills_accepted_counts(),
+			optical_returns_counts(),
+			magnetic_returns_counts(),
+			capacitance_returns_counts(),
+			unrecognized_bills_count(0),
+			length_returns_count(0),
+			magnetic_failures_count(0),
+			optical_failures_count(0),
+			transport_failures_count(0),
+			stacking_failures_count(0),
+			aligning_failures_count(0),
+			jams_counts(),
+			denominations() { }
+
+		std::uint64_t get_bills_accepted_count() const;
+		// the bills returned by the optical, magnetic, capacitance and length criteria and the unrecognized ones
+		std::uint64_t get_bills_rejected_count() const;
+		// the failures of the transport, stacking and aligning mechanisms
+		std::uint64_t get_motor_failures_count() const;
+		std::uint64_t get_jams_count() const;
+
+		std::uint64_t bills_inserted_count;
+		// by the positions of the denominations
+		std::array<std::uint64_t, denominations_count> bills_accepted_counts;
+		std::array<std::uint64_t, denominations_count> optical_returns_counts;
+		std::array<std::uint64_t, denominations_count> magnetic_returns_counts;
+		std::array<std::uint64_t, denominations_count> capacitance_returns_counts;
+		std::uint64_t unrecognized_bills_count;
+		std::uint64_t length_returns_count;
+		std::uint64_t magnetic_failures_count;
+		std::uint64_t optical_failures_count;
+		std::uint64_t transport_failures_count;
+		std::uint64_t stacking_failures_count;
+		std::uint64_t aligning_failures_count;
+		// by the jam places
+		std::array<std::uint64_t, jam_places_count> jams_counts;
+		// the denominations table of the device, the old and the new bills of a denomination
+		// are counted at separate positions; an unused position holds a zero denomination
+		std::array<cash_type, denominations_count> denominations;
+	};
+
+}
+
+#endif // CCNET_DEVICE_COUNTERS_H
@@ -0,0 +1,39 @@
+#ifndef CCNET_DEVICE_SNAPSHOT_H
+#define CCNET_DEVICE_SNAPSHOT_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include "ccnet.h"
+
+namespace ccnet {
+
+	// the identity, the bill table and the state of a bill validator
+	// as known to its handler at the moment of publishing;
+	// a snapshot is never modified, a new one is published instead
+	struct device_snapshot {
+		device_snapshot() :
+			is_initialized(false),
+			info(),
+			bill_table(),
+			state(device_state_code::unknown),
+			state_info(0),
+			update_time() { }
+
+		// false until the device has been initialized and after a communication failure
+		bool is_initialized;
+		device_info info;
+		// the cash types by the bill type numbers, shared by the snapshots published with the same table;
+		// never null in a published snapshot
+		std::shared_ptr<const std::map<std::uint8_t, cash_type>> bill_table;
+		// the last state reported in response to the poll command
+		device_state_code state;
+		// the bill type or the reason accompanying the state
+		std::uint8_t state_info;
+		std::chrono::steady_clock::time_point update_time;
+	};
+
+}
+
+#endif // CCNET_DEVICE_SNAPSHOT_H
@@ -0,0 +1,72 @@
+#ifndef CCNET_DEVICE_STATISTICS_H
+#define CCNET_DEVICE_STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+namespace ccnet {
+
+	// the distribution of the command latencies in buckets growing by powers of two,
+	// the bucket n counts the latencies from 2^n to 2^(n + 1) microseconds
+	// (the first one starts from zero and the last one has no upper bound)
+	struct latency_histogram {
+		static const std::size_t buckets_count = 24;
+
+		latency_histogram() :
+			buckets(),
+			count(0),
+			total_latency(0) { }
+
+		// the upper bound of the bucket the quantile (0 to 1) falls into
+		std::chrono::microseconds get_quantile(double quantile) const;
+		std::chrono::microseconds get_average() const;
+
+		std::array<std::uint64_t, buckets_count> buckets;
+		std::uint64_t count;
+		std::chrono::microseconds total_latency;
+	};
+
+	// a snapshot of the protocol counters of a bill validator
+	// accumulated since the connection
+	struct device_statistics {
+		device_statistics() :
+			commands_count(0),
+			acks_count(0),
+			naks_count(0),
+			illegal_commands_count(0),
+			timeouts_count(0),
+			crc_errors_count(0),
+			sync_losses_count(0),
+			retries_count(0),
+			journal_errors_count(0),
+			command_latencies(),
+			exchange_latencies() { }
+
+		std::uint64_t commands_count;
+		// the control packets received from the device
+		std::uint64_t acks_count;
+		std::uint64_t naks_count;
+		std::uint64_t illegal_commands_count;
+		// the commands the device has not responded to within t-response
+		std::uint64_t timeouts_count;
+		// the frames failing the frame check sequence
+		std::uint64_t crc_errors_count;
+		// the times the received bytes were discarded to find the next sync byte
+		std::uint64_t sync_losses_count;
+		// the repeated transmissions of the commands
+		std::uint64_t retries_count;
+		// the events the journal has failed to take, e.g. when its file could not grow;
+		// the device is polled on, so the bills have to be reconciled from elsewhere
+		std::uint64_t journal_errors_count;
+		// the time from sending a command to receiving its response, by command codes
+		std::map<std::uint8_t, latency_histogram> command_latencies;
+		// the time from the end of sending a frame to receiving the whole response,
+		// the turnaround of the device and the serial path (see connection_options::transport)
+		latency_histogram exchange_latencies;
+	};
+
+}
+
+#endif // CCNET_DEVICE_STATISTICS_H
@@ -0,0 +1,33 @@
+#ifndef CCNET_ESCROW_POLICY_H
+#define CCNET_ESCROW_POLICY_H
+
+#include <chrono>
+#include "ccnet.h"
+
+namespace ccnet {
+
+	// the handling of a bill held in escrow while the operator decides on it;
+	// the device keeps being polled until the decision arrives
+	struct escrow_policy {
+		escrow_policy(
+			std::chrono::milliseconds decision_timeout = std::chrono::milliseconds(10000),
+			cash_action default_action = cash_action::return_cash,
+			std::chrono::milliseconds hold_interval = std::chrono::milliseconds(5000)
+		) :
+			decision_timeout(decision_timeout),
+			default_action(default_action),
+			hold_interval(hold_interval) { }
+
+		// the time the operator has to decide on the bill
+		std::chrono::milliseconds decision_timeout;
+		// the action taken if the decision has not arrived in time or has failed,
+		// holding the cash asks the operator again
+		cash_action default_action;
+		// the interval between the HOLD commands keeping the bill in escrow,
+		// has to be shorter than the escrow timeout of the device (10 s)
+		std::chrono::milliseconds hold_interval;
+	};
+
+}
+
+#endif // CCNET_ESCROW_POLICY_H
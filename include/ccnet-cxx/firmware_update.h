@@ -0,0 +1,23 @@
+#ifndef CCNET_FIRMWARE_UPDATE_H
+#define CCNET_FIRMWARE_UPDATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ccnet {
+
+	enum class firmware_update_result : std::uint8_t {
+		// the CRC32 reported by the device matches the image, nothing has been downloaded
+		up_to_date = 1,
+		// the image has been downloaded and verified
+		updated = 2
+	};
+
+	// receives the number of the image bytes downloaded so far and the image size;
+	// invoked on the handler thread after every block, so it has to return quickly
+	typedef std::function<void(std::size_t downloaded_size, std::size_t image_size)> firmware_progress_handler;
+
+}
+
+#endif // CCNET_FIRMWARE_UPDATE_H
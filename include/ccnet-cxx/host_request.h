@@ -0,0 +1,104 @@
+#ifndef CCNET_HOST_REQUEST_H
+#define CCNET_HOST_REQUEST_H
+
+#include <exception>
+#include <utility>
+#include <boost/asio.hpp>
+
+namespace ccnet {
+
+	// a host request waiting to be processed by the handler thread
+	class request {
+		public:
+			virtual ~request() = default;
+
+			virtual void fail(std::exception_ptr error) = 0;
+	};
+
+	// a request completed with a result of the specified type,
+	// either through a promise or through an asynchronous completion handler
+	template<typename T>
+	class typed_request : public request {
+		public:
+			virtual void set_value(T value) = 0;
+	};
+
+	template<>
+	class typed_request<void> : public request {
+		public:
+			virtual void set_value() = 0;
+	};
+
+	// the completion signature of a request with a result of the specified type
+	template<typename T>
+	struct request_completion_signature {
+		typedef void type(std::exception_ptr, T);
+	};
+
+	template<>
+	struct request_completion_signature<void> {
+		typedef void type(std::exception_ptr);
+	};
+
+	// invokes the completion handler with (std::exception_ptr, T) on its associated executor,
+	// so the handler never runs on the handler thread;
+	// the executor is kept busy until the request is completed
+	template<typename T, typename Handler>
+	class handler_request : public typed_request<T> {
+		public:
+			explicit handler_request(Handler handler) :
+				handler(std::move(handler)),
+				work(boost::asio::get_associated_executor(this->handler)) { }
+
+			void set_value(T value) override {
+				this->complete(std::exception_ptr(), std::move(value));
+			}
+
+			void fail(std::exception_ptr error) override {
+				this->complete(error, T());
+			}
+
+		private:
+			void complete(std::exception_ptr error, T value) {
+				boost::asio::post(this->work.get_executor(), [handler = std::move(this->handler), error, value = std::move(value)]() mutable {
+					handler(error, std::move(value));
+				});
+				this->work.reset();
+			}
+
+		private:
+			Handler handler;
+			boost::asio::executor_work_guard<boost::asio::associated_executor_t<Handler>> work;
+	};
+
+	template<typename Handler>
+	class handler_request<void, Handler> : public typed_request<void> {
+		public:
+			explicit handler_request(Handler handler) :
+				handler(std::move(handler)),
+				work(boost::asio::get_associated_executor(this->handler)) { }
+
+			void set_value() override {
+				this->complete(std::exception_ptr());
+			}
+
+			void fail(std::exception_ptr error) override {
+				this->complete(error);
+			}
+
+		private:
+			void complete(std::exception_ptr error) {
+				boost::asio::post(this->work.get_executor(), [handler = std::move(this->handler), error]() mutable {
+					handler(error);
+				});
+				this->work.reset();
+			}
+
+		private:
+			Handler handler;
+			boost::asio::executor_work_guard<boost::asio::associated_executor_t<Handler>> work;
+	};
+
+}
+
+#endif // CCNET_HOST_REQUEST_H
@@ -0,0 +1,47 @@
+#ifndef CCNET_POLL_POLICY_H
+#define CCNET_POLL_POLICY_H
+
+#include <chrono>
+#include <map>
+#include "ccnet.h"
+
+namespace ccnet {
+
+	// intervals between two poll commands depending on the state reported by the bill validator
+	struct poll_policy {
+		poll_policy(
+			std::chrono::milliseconds active_interval = std::chrono::milliseconds(40),
+			std::chrono::milliseconds default_interval = std::chrono::milliseconds(100),
+			std::chrono::milliseconds idle_interval = std::chrono::milliseconds(200),
+			std::chrono::milliseconds watchdog_interval = std::chrono::milliseconds(1000),
+			std::chrono::milliseconds statistics_interval = std::chrono::milliseconds(60000)
+		) :
+			active_interval(active_interval),
+			default_interval(default_interval),
+			idle_interval(idle_interval),
+			watchdog_interval(watchdog_interval),
+			statistics_interval(statistics_interval),
+			state_intervals() { }
+
+		std::chrono::milliseconds get_interval(device_state_code state_code) const;
+
+		// a bill is being processed (accepting, escrow position, stacking, returning, rejecting)
+		std::chrono::milliseconds active_interval;
+		// power up, initialization, holding and busy states
+		std::chrono::milliseconds default_interval;
+		// nothing is expected to happen soon (idling, unit disabled, pause)
+		std::chrono::milliseconds idle_interval;
+		// drop cassette and failure states
+		std::chrono::milliseconds watchdog_interval;
+		// the interval between two REQUEST STATISTICS commands, the first one an interval after the initialization;
+		// sent after a poll in the power up, initialization, failure or unit disabled states only, where the device accepts it,
+		// and only while the other devices on the line are in these states too, as the 4 KiB response
+		// keeps the line busy for about 5 s at 9600 baud; zero disables the collection
+		std::chrono::milliseconds statistics_interval;
+		// per-state intervals overriding the ones above
+		std::map<device_state_code, std::chrono::milliseconds> state_intervals;
+	};
+
+}
+
+#endif // CCNET_POLL_POLICY_H
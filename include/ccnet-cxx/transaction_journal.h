@@ -0,0 +1,95 @@
+#ifndef CCNET_TRANSACTION_JOURNAL_H
+#define CCNET_TRANSACTION_JOURNAL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "ccnet.h"
+
+namespace ccnet {
+
+	enum class journal_event : std::uint8_t {
+		// the device has reported another state
+		state_changed = 1,
+		// the bill has entered the escrow position
+		bill_escrowed = 2,
+		// STACK has been sent for the bill in escrow
+		stack_requested = 3,
+		// RETURN has been sent for the bill in escrow
+		return_requested = 4,
+		bill_stacked = 5,
+		bill_returned = 6,
+		// the device has been powered up with a bill in the validating head or in the stacker
+		power_up_with_bill = 7
+	};
+
+	struct journal_record {
+		journal_record() :
+			sequence_number(0),
+			time(),
+			device_address(0),
+			event(journal_event::state_changed),
+			state(device_state_code::unknown),
+			state_info(0),
+			cash() { }
+
+		std::uint64_t sequence_number;
+		std::chrono::system_clock::time_point time;
+		std::uint8_t device_address;
+		journal_event event;
+		device_state_code state;
+		// the bill type or the reason accompanying the state
+		std::uint8_t state_info;
+		// the cash type of the bill if it is known from the bill table
+		cash_type cash;
+	};
+
+	// an append-only journal of the money events of a bill validator in a memory-mapped file;
+	// the records have a fixed size, a sequence number and a CRC32 written last,
+	// so a record torn by a crash is recognized and ends the journal on the replay;
+	// the file grows in preallocated chunks, so appending a record makes no system call
+	// and the records survive a crash of the process as soon as they are appended
+	// (flush them to survive a crash of the system)
+	class transaction_journal {
+		public:
+			// opens the journal file or creates it,
+			// the records are read up to the first invalid one
+			explicit transaction_journal(const std::string& path);
+
+			transaction_journal(const transaction_journal& other) = delete;
+
+			transaction_journal& operator=(const transaction_journal& other) = delete;
+
+			// the journal is written by the handler thread of a single bill validator,
+			// the records are appended with the next sequence number
+			void append(journal_record& record);
+			// writes the appended records to the disk
+			void flush();
+
+			// the reading functions are not synchronised with the appending,
+			// they are meant for the replay before the journal is passed to a bill validator
+			std::uint64_t get_last_sequence_number() const;
+			std::vector<journal_record> read_records(std::uint64_t first_sequence_number = 1) const;
+			// the last bill of every device which has not been stacked or returned yet:
+			// an escrowed bill, a bill with STACK or RETURN sent, or a bill found on the power up
+			std::vector<journal_record> get_unsettled_records() const;
+
+		private:
+			// extends the file by a chunk and maps it again
+			void grow(std::size_t records_capacity);
+
+		private:
+			std::string path;
+			boost::interprocess::file_mapping file;
+			boost::interprocess::mapped_region region;
+			std::size_t records_capacity;
+			std::size_t records_count;
+	};
+
+}
+
+#endif // CCNET_TRANSACTION_JOURNAL_H
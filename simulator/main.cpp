@@ -0,0 +1,126 @@
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "virtual_bill_validator.h"
+
+using namespace ccnet;
+
+// runs a virtual bill validator on a pseudo-terminal and prints the port name;
+// the events are read from the script or the standard input, one per line:
+//   [delay in milliseconds] event [argument]
+// where the event is one of
+//   insert <bill type number>
+//   remove_cassette
+//   insert_cassette
+//   cassette_full <0 or 1>
+//   latency <response latency in microseconds>
+// the device keeps running after the last event until the process is interrupted
+
+void print_usage() {
+	std::cerr << "usage: ccnet-simulator [-a device address] [-b baud rate] [-l response latency in microseconds] [script]" << std::endl;
+}
+
+void process_event(virtual_bill_validator& device, const std::string& event, std::istringstream& arguments) {
+	unsigned long argument = 0;
+
+	if (event == "insert") {
+		if (!(arguments >> argument)) {
+			throw std::runtime_error("bill type number expected");
+		}
+
+		device.insert_bill((std::uint8_t)argument);
+	} else if (event == "remove_cassette") {
+		device.remove_cassette();
+	} else if (event == "insert_cassette") {
+		device.insert_cassette();
+	} else if (event == "cassette_full") {
+		if (!(arguments >> argument)) {
+			throw std::runtime_error("cassette state expected");
+		}
+
+		device.set_cassette_full(argument != 0);
+	} else if (event == "latency") {
+		if (!(arguments >> argument)) {
+			throw std::runtime_error("latency expected");
+		}
+
+		device.set_response_latency(std::chrono::microseconds(argument));
+	} else {
+		throw std::runtime_error("unknown event: " + event);
+	}
+}
+
+void run_script(virtual_bill_validator& device, std::istream& script) {
+	std::string line;
+
+	while (std::getline(script, line)) {
+		std::istringstream line_stream(line);
+		std::string token;
+
+		if ((!(line_stream >> token)) || (token[0] == '#')) {
+			continue;
+		}
+
+		if (std::isdigit((unsigned char)token[0])) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(std::stoul(token)));
+
+			if (!(line_stream >> token)) {
+				continue;
+			}
+		}
+
+		process_event(device, token, line_stream);
+	}
+}
+
+int main(int argc, char** argv) {
+	virtual_bill_validator::configuration device_configuration;
+	std::string script_name;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+
+		if ((argument == "-a") && (i + 1 < argc)) {
+			device_configuration.device_address = (std::uint8_t)std::strtoul(argv[++i], nullptr, 0);
+		} else if ((argument == "-b") && (i + 1 < argc)) {
+			device_configuration.baud_rate = (std::uint32_t)std::strtoul(argv[++i], nullptr, 0);
+		} else if ((argument == "-l") && (i + 1 < argc)) {
+			device_configuration.response_latency = std::chrono::microseconds(std::strtoul(argv[++i], nullptr, 0));
+		} else if ((argument[0] != '-') && script_name.empty()) {
+			script_name = argument;
+		} else {
+			print_usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	try {
+		virtual_bill_validator device(device_configuration);
+		std::cout << device.get_port_name() << std::endl;
+
+		if (script_name.empty()) {
+			run_script(device, std::cin);
+		} else {
+			std::ifstream script(script_name);
+
+			if (!script) {
+				throw std::runtime_error("unable to open " + script_name);
+			}
+
+			run_script(device, script);
+		}
+
+		for (;;) {
+			std::this_thread::sleep_for(std::chrono::hours(1));
+		}
+	} catch (std::exception& error) {
+		std::cerr << error.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
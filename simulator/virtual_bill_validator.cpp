@@ -0,0 +1,704 @@
+#include "virtual_bill_validator.h"
+#include <algorithm>
+#include <stdexcept>
+#include <boost/crc.hpp>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include "protocol.h"
+
+using namespace boost::asio;
+using namespace ccnet;
+
+// command codes
+const std::uint8_t reset_command = 0x30;
+const std::uint8_t get_status_command = 0x31;
+const std::uint8_t set_security_command = 0x32;
+const std::uint8_t poll_command = 0x33;
+const std::uint8_t enable_bill_types_command = 0x34;
+const std::uint8_t stack_command = 0x35;
+const std::uint8_t return_command = 0x36;
+const std::uint8_t identification_command = 0x37;
+const std::uint8_t hold_command = 0x38;
+const std::uint8_t get_bill_table_command = 0x41;
+const std::uint8_t download_command = 0x50;
+const std::uint8_t get_crc32_command = 0x51;
+const std::uint8_t request_statistics_command = 0x60;
+
+const std::size_t bill_types_count_max = 24;
+const std::size_t bill_type_record_size = 5;
+const std::size_t part_number_size = 15;
+const std::size_t serial_number_size = 12;
+const std::size_t asset_number_size = 7;
+const std::uint8_t exponent_sign_bit = 0x80;
+// the REQUEST STATISTICS response: the identification block, 16 sets of 10000 bills,
+// 20 sets of 500 bills and 20 sets of 50 bills, the denominations table and the currency names
+const std::size_t statistics_identification_size = 32;
+const std::size_t statistics_sets_count = 16;
+const std::size_t statistics_set_size = 179;
+const std::size_t statistics_fine_aggregates_size = 20 * 66 + 20 * 1;
+const std::size_t statistics_denominations_count = 20;
+const std::size_t currency_names_size = 20;
+// the identification block: the country code, the denominations count,
+// the format version, the reset time and the serial number
+const std::size_t statistics_denominations_count_offset = 3;
+const std::size_t statistics_format_version_offset = 4;
+const std::size_t statistics_serial_number_offset = 13;
+const std::uint8_t statistics_format_version = 1;
+// the counters of a set of 10000 bills
+const std::size_t bills_inserted_counter_offset = 0;
+const std::size_t bills_accepted_counters_offset = 2;
+const std::size_t unrecognized_bills_counter_offset = 162;
+const std::size_t bill_counter_size = 2;
+// the DOWNLOAD subcommands and the boot loader statuses
+const std::uint8_t download_request_status = 0x00;
+const std::uint8_t download_request_block_size = 0x01;
+const std::uint8_t download_write = 0x02;
+const std::uint8_t download_exit = 0x03;
+const std::uint8_t download_ready = 0x00;
+const std::uint8_t download_succeeded = 0xe0;
+const std::uint8_t download_failed = 0xe1;
+const std::uint8_t download_crc_mismatch = 0xe2;
+// blocks of 2^9 bytes, written in extended frames after their little-endian address
+const std::uint8_t download_block_size_index = 9;
+const std::size_t download_address_size = 3;
+// the value of the erased flash the last block is padded with
+const std::uint8_t erased_byte = 0xff;
+// the rejection reason reported for a disabled bill type
+const std::uint8_t reject_inhibit = 0x68;
+
+// the denomination, the country code and the decimal exponent
+void encode_bill_type(const virtual_bill_validator::bill_type& record, std::uint8_t* record_data) {
+	record_data[0] = record.denomination;
+	std::copy_n(record.country_code.cbegin(), std::min<std::size_t>(record.country_code.size(), 3), record_data + 1);
+	record_data[4] = (record.exponent < 0) ? (exponent_sign_bit | (std::uint8_t)(-record.exponent)) : (std::uint8_t)record.exponent;
+}
+
+// the bytes sent at another rate than the device uses are garbage
+speed_t get_speed(std::uint32_t baud_rate) {
+	switch (baud_rate) {
+		case 1200: return B1200;
+		case 2400: return B2400;
+		case 4800: return B4800;
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+		default: throw std::runtime_error("unsupported baud rate");
+	}
+}
+
+virtual_bill_validator::configuration::configuration() :
+	device_address(0x03),
+	baud_rate(0),
+	response_latency(1000),
+	escrow_timeout(10000),
+	part_number("SM-RU1353"),
+	serial_number("41K000000001"),
+	asset_number(0),
+	bill_table({
+		bill_type(1, "RUS", 1),
+		bill_type(5, "RUS", 1),
+		bill_type(1, "RUS", 2),
+		bill_type(5, "RUS", 2),
+		bill_type(1, "RUS", 3),
+		bill_type(5, "RUS", 3)
+	}),
+	firmware() { }
+
+virtual_bill_validator::virtual_bill_validator(const configuration& device_configuration) :
+	device_configuration(device_configuration),
+	io_service(),
+	master(io_service),
+	slave_descriptor(-1),
+	port_name(),
+	response_timer(io_service),
+	io_thread(),
+	parser(frame_parser::frame_sender::controller),
+	last_response(),
+	response_latency(device_configuration.response_latency),
+	commands_count(0),
+	state(device_state_code::power_up),
+	state_info(0),
+	escrow_deadline(),
+	inserted_bills(),
+	is_cassette_removed(false),
+	is_cassette_full(false),
+	enabled_bill_types(),
+	escrow_bill_types(),
+	high_security_bill_types(),
+	firmware(device_configuration.firmware),
+	is_download_mode(false),
+	download_status(download_ready),
+	written_firmware(),
+	statistics_set(statistics_set_size) {
+	if (device_configuration.bill_table.size() > bill_types_count_max) {
+		throw std::runtime_error("invalid arguments");
+	}
+
+	if (device_configuration.baud_rate != 0) {
+		// throws if the rate is not supported
+		get_speed(device_configuration.baud_rate);
+	}
+
+	const int master_descriptor = ::posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (master_descriptor < 0) {
+		throw std::runtime_error("unable to open pseudo-terminal");
+	}
+
+	this->master.assign(master_descriptor);
+
+	const char* slave_name = nullptr;
+	if ((::grantpt(master_descriptor) != 0) || (::unlockpt(master_descriptor) != 0) || ((slave_name = ::ptsname(master_descriptor)) == nullptr)) {
+		throw std::runtime_error("unable to open pseudo-terminal");
+	}
+
+	this->port_name = slave_name;
+	this->slave_descriptor = ::open(slave_name, O_RDWR | O_NOCTTY);
+
+	if (this->slave_descriptor < 0) {
+		throw std::runtime_error("unable to open pseudo-terminal");
+	}
+
+	// pass the bytes unchanged
+	termios attributes;
+	::tcgetattr(this->slave_descriptor, &attributes);
+	::cfmakeraw(&attributes);
+	::tcsetattr(this->slave_descriptor, TCSANOW, &attributes);
+
+	this->receive();
+	this->io_thread = std::thread([this]() { this->io_service.run(); });
+}
+
+virtual_bill_validator::~virtual_bill_validator() {
+	this->io_service.stop();
+
+	if (this->io_thread.joinable()) {
+		this->io_thread.join();
+	}
+
+	if (this->slave_descriptor >= 0) {
+		::close(this->slave_descriptor);
+	}
+}
+
+const std::string& virtual_bill_validator::get_port_name() const {
+	return this->port_name;
+}
+
+void virtual_bill_validator::insert_bill(std::uint8_t bill_type_number) {
+	post(this->io_service, [this, bill_type_number]() { this->inserted_bills.push_back(bill_type_number); });
+}
+
+void virtual_bill_validator::remove_cassette() {
+	post(this->io_service, [this]() { this->is_cassette_removed = true; });
+}
+
+void virtual_bill_validator::insert_cassette() {
+	post(this->io_service, [this]() { this->is_cassette_removed = false; });
+}
+
+void virtual_bill_validator::set_cassette_full(bool is_cassette_full) {
+	post(this->io_service, [this, is_cassette_full]() { this->is_cassette_full = is_cassette_full; });
+}
+
+void virtual_bill_validator::set_response_latency(std::chrono::microseconds response_latency) {
+	post(this->io_service, [this, response_latency]() { this->response_latency = response_latency; });
+}
+
+std::size_t virtual_bill_validator::get_commands_count() const {
+	return this->commands_count.load(std::memory_order_relaxed);
+}
+
+void virtual_bill_validator::receive() {
+	this->master.async_read_some(buffer(this->parser.get_write_position(), this->parser.get_write_size()),
+		[this](const boost::system::error_code& result, std::size_t size) {
+			if (result) {
+				// the descriptor is closed
+				return;
+			}
+
+			if (!this->is_baud_rate_matching()) {
+				// the frames sent at another rate are not recognized
+				this->receive();
+				return;
+			}
+
+			this->parser.commit(size);
+
+			frame request;
+			frame_parser::result parse_result;
+			while ((parse_result = this->parser.parse(request)) != frame_parser::result::incomplete) {
+				if (parse_result == frame_parser::result::frame_received) {
+					this->process_frame(request);
+				} else if (parse_result == frame_parser::result::extended_frame_received) {
+					this->process_extended_frame(this->parser.get_extended_frame());
+				}
+			}
+
+			this->receive();
+		});
+}
+
+bool virtual_bill_validator::is_baud_rate_matching() const {
+	if (this->device_configuration.baud_rate == 0) {
+		return true;
+	}
+
+	termios attributes;
+	return (::tcgetattr(this->slave_descriptor, &attributes) == 0)
+		&& (::cfgetispeed(&attributes) == get_speed(this->device_configuration.baud_rate));
+}
+
+void virtual_bill_validator::process_frame(const frame& request) {
+	if (request[adr_offset] != this->device_configuration.device_address) {
+		return;
+	}
+
+	const std::uint8_t code = request[header_size];
+	const std::uint8_t* data = request.data() + header_size + 1;
+	const std::size_t data_size = request.size() - header_size - 1 - sizeof(std::uint16_t);
+
+	if ((code == ack) && (data_size == 0)) {
+		return;
+	}
+
+	if ((code == nak) && (data_size == 0)) {
+		// the host has not received the last response correctly
+		this->send(this->last_response);
+		return;
+	}
+
+	this->commands_count.fetch_add(1, std::memory_order_relaxed);
+
+	if (this->is_download_mode) {
+		if ((code == download_command) && (data_size == 1)) {
+			this->process_download_subcommand(data[0], nullptr, 0);
+		}
+		return;
+	}
+
+	this->process_command(code, data, data_size);
+}
+
+void virtual_bill_validator::process_extended_frame(const extended_frame& request) {
+	if (request[adr_offset] != this->device_configuration.device_address) {
+		return;
+	}
+
+	this->commands_count.fetch_add(1, std::memory_order_relaxed);
+
+	if ((!this->is_download_mode) || (request[header_size] != download_command)) {
+		return;
+	}
+
+	// the length follows the command and the subcommand
+	const std::size_t data_offset = header_size + 2 + extended_length_size;
+	this->process_download_subcommand(request[header_size + 1], request.data() + data_offset, request.size() - data_offset - sizeof(std::uint16_t));
+}
+
+void virtual_bill_validator::process_command(std::uint8_t code, const std::uint8_t* data, std::size_t data_size) {
+	switch (code) {
+		case reset_command: {
+			// the reset disables all the bill types and restores the normal security level
+			this->inserted_bills.clear();
+			this->enabled_bill_types.fill(0);
+			this->escrow_bill_types.fill(0);
+			this->high_security_bill_types.fill(0);
+			this->set_state(device_state_code::initialize);
+			this->respond(ack);
+			break;
+		}
+		case get_status_command: {
+			std::uint8_t status[6];
+			std::copy(this->enabled_bill_types.cbegin(), this->enabled_bill_types.cend(), status);
+			std::copy(this->high_security_bill_types.cbegin(), this->high_security_bill_types.cend(), status + 3);
+			this->respond(status, sizeof(status));
+			break;
+		}
+		case set_security_command: {
+			if (data_size != this->high_security_bill_types.size()) {
+				this->respond(ill_cmd);
+				break;
+			}
+
+			std::copy(data, data + data_size, this->high_security_bill_types.begin());
+			this->respond(ack);
+			break;
+		}
+		case poll_command: {
+			this->poll();
+			break;
+		}
+		case enable_bill_types_command: {
+			if (data_size != this->enabled_bill_types.size() + this->escrow_bill_types.size()) {
+				this->respond(ill_cmd);
+				break;
+			}
+
+			std::copy(data, data + 3, this->enabled_bill_types.begin());
+			std::copy(data + 3, data + 6, this->escrow_bill_types.begin());
+
+			if ((this->state == device_state_code::idling) || (this->state == device_state_code::unit_disabled)) {
+				this->set_state(this->get_rest_state());
+			}
+
+			this->respond(ack);
+			break;
+		}
+		case stack_command:
+		case return_command: {
+			if ((this->state != device_state_code::escrow_pos) && (this->state != device_state_code::holding)) {
+				this->respond(ill_cmd);
+				break;
+			}
+
+			this->set_state((code == stack_command) ? device_state_code::stacking : device_state_code::returning, this->state_info);
+			this->respond(ack);
+			break;
+		}
+		case identification_command: {
+			std::uint8_t identification[part_number_size + serial_number_size + asset_number_size];
+			std::fill(identification, identification + part_number_size + serial_number_size, ' ');
+			std::copy_n(this->device_configuration.part_number.cbegin(), std::min(this->device_configuration.part_number.size(), part_number_size), identification);
+			std::copy_n(this->device_configuration.serial_number.cbegin(), std::min(this->device_configuration.serial_number.size(), serial_number_size), identification + part_number_size);
+
+			// the asset number is sent most significant byte first
+			for (std::size_t i = 0; i < asset_number_size; ++i) {
+				identification[part_number_size + serial_number_size + i] = (std::uint8_t)(this->device_configuration.asset_number >> (8 * (asset_number_size - 1 - i)));
+			}
+
+			this->respond(identification, sizeof(identification));
+			break;
+		}
+		case hold_command: {
+			if ((this->state != device_state_code::escrow_pos) && (this->state != device_state_code::holding)) {
+				this->respond(ill_cmd);
+				break;
+			}
+
+			this->set_state(device_state_code::holding, this->state_info);
+			this->escrow_deadline = std::chrono::steady_clock::now() + this->device_configuration.escrow_timeout;
+			this->respond(ack);
+			break;
+		}
+		case get_bill_table_command: {
+			std::uint8_t bill_table[bill_types_count_max * bill_type_record_size] = {};
+
+			for (std::size_t i = 0; i < this->device_configuration.bill_table.size(); ++i) {
+				encode_bill_type(this->device_configuration.bill_table[i], bill_table + i * bill_type_record_size);
+			}
+
+			this->respond(bill_table, sizeof(bill_table));
+			break;
+		}
+		case download_command: {
+			// the subcommands are accepted by the boot loader only
+			if ((data_size != 0) || (!this->is_service_state())) {
+				this->respond(ill_cmd);
+				break;
+			}
+
+			this->is_download_mode = true;
+			this->download_status = download_ready;
+			this->written_firmware.clear();
+			this->respond(ack);
+			break;
+		}
+		case get_crc32_command: {
+			if (!this->is_service_state()) {
+				this->respond(ill_cmd);
+				break;
+			}
+
+			boost::crc_32_type crc;
+			crc.process_bytes(this->firmware.data(), this->firmware.size());
+
+			const std::uint32_t checksum = crc.checksum();
+			const std::uint8_t checksum_data[] = { (std::uint8_t)(checksum >> 24), (std::uint8_t)(checksum >> 16), (std::uint8_t)(checksum >> 8), (std::uint8_t)checksum };
+			this->respond(checksum_data, sizeof(checksum_data));
+			break;
+		}
+		case request_statistics_command: {
+			if (!this->is_service_state()) {
+				this->respond(ill_cmd);
+				break;
+			}
+
+			std::vector<std::uint8_t> statistics(statistics_identification_size + statistics_sets_count * statistics_set_size
+				+ statistics_fine_aggregates_size + statistics_denominations_count * bill_type_record_size + currency_names_size);
+			const std::size_t denominations_count = std::min(this->device_configuration.bill_table.size(), statistics_denominations_count);
+
+			// the statistics have never been reset
+			if (denominations_count != 0) {
+				const std::string& country_code = this->device_configuration.bill_table[0].country_code;
+				std::copy_n(country_code.cbegin(), std::min<std::size_t>(country_code.size(), 3), statistics.begin());
+			}
+			statistics[statistics_denominations_count_offset] = (std::uint8_t)denominations_count;
+			statistics[statistics_format_version_offset] = statistics_format_version;
+			std::copy_n(this->device_configuration.serial_number.cbegin(), std::min(this->device_configuration.serial_number.size(), serial_number_size),
+				statistics.begin() + statistics_serial_number_offset);
+
+			// the sets not used yet are zeroed, the current one is the last
+			const std::size_t sets_offset = statistics_identification_size;
+			std::copy(this->statistics_set.cbegin(), this->statistics_set.cend(), statistics.begin() + sets_offset + (statistics_sets_count - 1) * statistics_set_size);
+
+			// the finer aggregates are left zeroed, the denominations are the bill types
+			// and the list of the currency names is empty
+			const std::size_t denominations_offset = sets_offset + statistics_sets_count * statistics_set_size + statistics_fine_aggregates_size;
+			for (std::size_t i = 0; i < denominations_count; ++i) {
+				encode_bill_type(this->device_configuration.bill_table[i], statistics.data() + denominations_offset + i * bill_type_record_size);
+			}
+			statistics[denominations_offset + statistics_denominations_count * bill_type_record_size] = '.';
+
+			this->respond_extended(statistics.data(), statistics.size());
+			break;
+		}
+		default: {
+			this->respond(ill_cmd);
+			break;
+		}
+	}
+}
+
+void virtual_bill_validator::process_download_subcommand(std::uint8_t subcommand, const std::uint8_t* data, std::size_t data_size) {
+	switch (subcommand) {
+		case download_request_status: {
+			this->respond(this->download_status);
+			break;
+		}
+		case download_request_block_size: {
+			this->respond(download_block_size_index);
+			break;
+		}
+		case download_write: {
+			const std::size_t block_size = (std::size_t)1 << download_block_size_index;
+
+			if (data_size != download_address_size + block_size) {
+				this->download_status = download_failed;
+				this->respond(this->download_status);
+				break;
+			}
+
+			const std::size_t address = data[0] | ((std::size_t)data[1] << 8) | ((std::size_t)data[2] << 16);
+			if (this->written_firmware.size() < address + block_size) {
+				this->written_firmware.resize(address + block_size, erased_byte);
+			}
+
+			std::copy(data + download_address_size, data + data_size, this->written_firmware.begin() + address);
+			this->download_status = download_succeeded;
+			this->respond(this->download_status);
+			break;
+		}
+		case download_exit: {
+			// a real image carries its own check, the simulated one is only to be written;
+			// it ends before the padding of the last block
+			while ((!this->written_firmware.empty()) && (this->written_firmware.back() == erased_byte)) {
+				this->written_firmware.pop_back();
+			}
+
+			if (this->written_firmware.empty()) {
+				this->respond(download_crc_mismatch);
+				break;
+			}
+
+			// the device starts the new firmware
+			this->firmware.swap(this->written_firmware);
+			this->written_firmware.clear();
+			this->is_download_mode = false;
+			this->set_state(device_state_code::power_up);
+			this->respond(download_succeeded);
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+}
+
+void virtual_bill_validator::poll() {
+	// the bill type or the rejection reason follows the state code
+	if ((this->state == device_state_code::escrow_pos) || (this->state == device_state_code::bill_stacked)
+		|| (this->state == device_state_code::bill_returned) || (this->state == device_state_code::rejecting)) {
+		const std::uint8_t state_data[] = { (std::uint8_t)this->state, this->state_info };
+		this->respond(state_data, sizeof(state_data));
+	} else {
+		const std::uint8_t state_data[] = { (std::uint8_t)this->state };
+		this->respond(state_data, sizeof(state_data));
+	}
+
+	// the cassette events interrupt the resting states only
+	const bool is_resting = (this->state == device_state_code::idling) || (this->state == device_state_code::unit_disabled)
+		|| (this->state == device_state_code::drop_cassette_full) || (this->state == device_state_code::drop_cassette_out_of_pos);
+
+	if (is_resting && this->is_cassette_removed) {
+		this->set_state(device_state_code::drop_cassette_out_of_pos);
+		return;
+	}
+
+	switch (this->state) {
+		case device_state_code::power_up: {
+			// waiting for the reset command
+			break;
+		}
+		case device_state_code::drop_cassette_out_of_pos: {
+			// the device initializes after the cassette has been inserted
+			this->set_state(device_state_code::initialize);
+			break;
+		}
+		case device_state_code::initialize:
+		case device_state_code::drop_cassette_full:
+		case device_state_code::rejecting:
+		case device_state_code::bill_stacked:
+		case device_state_code::bill_returned: {
+			this->set_state(this->is_cassette_full ? device_state_code::drop_cassette_full : this->get_rest_state());
+			break;
+		}
+		case device_state_code::idling:
+		case device_state_code::unit_disabled: {
+			// the bills inserted into a disabled device wait until it is enabled
+			if (this->is_cassette_full) {
+				this->set_state(device_state_code::drop_cassette_full);
+			} else if ((this->state == device_state_code::idling) && (!this->inserted_bills.empty())) {
+				const std::uint8_t bill_type_number = this->inserted_bills.front();
+				this->inserted_bills.pop_front();
+				this->count(bills_inserted_counter_offset, bill_counter_size);
+
+				if ((bill_type_number < this->device_configuration.bill_table.size()) && this->is_bill_type_set(this->enabled_bill_types, bill_type_number)) {
+					this->set_state(device_state_code::accepting, bill_type_number);
+				} else {
+					this->set_state(device_state_code::rejecting, reject_inhibit);
+				}
+			}
+			break;
+		}
+		case device_state_code::accepting: {
+			if (this->is_bill_type_set(this->escrow_bill_types, this->state_info)) {
+				this->set_state(device_state_code::escrow_pos, this->state_info);
+				this->escrow_deadline = std::chrono::steady_clock::now() + this->device_configuration.escrow_timeout;
+			} else {
+				this->set_state(device_state_code::stacking, this->state_info);
+			}
+			break;
+		}
+		case device_state_code::escrow_pos:
+		case device_state_code::holding: {
+			if (std::chrono::steady_clock::now() >= this->escrow_deadline) {
+				this->set_state(device_state_code::returning, this->state_info);
+			}
+			break;
+		}
+		case device_state_code::stacking: {
+			this->set_state(device_state_code::bill_stacked, this->state_info);
+			break;
+		}
+		case device_state_code::returning: {
+			this->set_state(device_state_code::bill_returned, this->state_info);
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+}
+
+void virtual_bill_validator::respond(const std::uint8_t* data, std::size_t data_size) {
+	frame response;
+	encode_frame(response, this->device_configuration.device_address, data[0], data + 1, data_size - 1);
+	this->last_response.assign(response.cbegin(), response.cend());
+	this->send(this->last_response);
+}
+
+void virtual_bill_validator::respond(std::uint8_t control_code) {
+	this->respond(&control_code, 1);
+}
+
+void virtual_bill_validator::respond_extended(const std::uint8_t* data, std::size_t data_size) {
+	encode_extended_frame(this->last_response, this->device_configuration.device_address, nullptr, 0, data, data_size);
+	this->send(this->last_response);
+}
+
+void virtual_bill_validator::send(const extended_frame& response) {
+	if (this->response_latency.count() == 0) {
+		boost::asio::write(this->master, buffer(response.data(), response.size()));
+		return;
+	}
+
+	// a new command cancels the response which has not been sent yet
+	this->response_timer.expires_after(this->response_latency);
+	this->response_timer.async_wait([this, response](const boost::system::error_code& result) {
+		if (!result) {
+			boost::asio::write(this->master, buffer(response.data(), response.size()));
+		}
+	});
+}
+
+bool virtual_bill_validator::is_bill_type_set(const std::array<std::uint8_t, 3>& mask, std::uint8_t bill_type_number) const {
+	return (mask[2 - bill_type_number / 8] & (1 << (bill_type_number % 8))) != 0;
+}
+
+bool virtual_bill_validator::is_service_state() const {
+	switch (this->state) {
+		case device_state_code::power_up:
+		case device_state_code::power_up_with_bill_in_val:
+		case device_state_code::power_up_with_bill_in_stack:
+		case device_state_code::initialize:
+		case device_state_code::unit_disabled:
+		case device_state_code::drop_cassette_full:
+		case device_state_code::drop_cassette_out_of_pos:
+		case device_state_code::validator_jammed:
+		case device_state_code::drop_cassette_jammed:
+		case device_state_code::cheated:
+		case device_state_code::pause:
+		case device_state_code::failure: {
+			return true;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+device_state_code virtual_bill_validator::get_rest_state() const {
+	const bool is_enabled = std::any_of(this->enabled_bill_types.cbegin(), this->enabled_bill_types.cend(), [](std::uint8_t byte) { return byte != 0; });
+
+	return is_enabled ? device_state_code::idling : device_state_code::unit_disabled;
+}
+
+void virtual_bill_validator::set_state(device_state_code code, std::uint8_t info) {
+	// the events are counted when the state is entered
+	switch ((code != this->state) ? code : device_state_code::unknown) {
+		case device_state_code::bill_stacked: {
+			// the bill types are the positions of the denominations
+			if (info < statistics_denominations_count) {
+				this->count(bills_accepted_counters_offset + info * bill_counter_size, bill_counter_size);
+			}
+			break;
+		}
+		case device_state_code::rejecting: {
+			// the simulated rejections do not tell the denomination of the bill
+			this->count(unrecognized_bills_counter_offset, bill_counter_size);
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+
+	this->state = code;
+	this->state_info = info;
+}
+
+void virtual_bill_validator::count(std::size_t offset, std::size_t size) {
+	for (std::size_t i = offset + size; i > offset; --i) {
+		if (this->statistics_set[i - 1] != 0xff) {
+			++this->statistics_set[i - 1];
+			std::fill(this->statistics_set.begin() + i, this->statistics_set.begin() + offset + size, 0);
+			return;
+		}
+	}
+}
@@ -0,0 +1,146 @@
+#ifndef CCNET_VIRTUAL_BILL_VALIDATOR_H
+#define CCNET_VIRTUAL_BILL_VALIDATOR_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include "ccnet.h"
+#include "frame.h"
+#include "frame_parser.h"
+
+namespace ccnet {
+
+	// a bill validator emulated on a pseudo-terminal;
+	// the device side of the protocol is served on the master side
+	// while the host opens the slave side as a serial port
+	class virtual_bill_validator {
+		public:
+			// a record of the bill table
+			struct bill_type {
+				bill_type(std::uint8_t denomination = 0, const std::string& country_code = "", std::int8_t exponent = 0) :
+					denomination(denomination),
+					country_code(country_code),
+					exponent(exponent) { }
+
+				std::uint8_t denomination;
+				std::string country_code;
+				// the power of ten the denomination is multiplied by
+				std::int8_t exponent;
+			};
+
+			struct configuration {
+				configuration();
+
+				std::uint8_t device_address;
+				// the rate the host has to set on the line to be heard, 0 for any
+				std::uint32_t baud_rate;
+				// the delay before every response
+				std::chrono::microseconds response_latency;
+				// the time a bill stays in escrow or on hold before it is returned
+				std::chrono::milliseconds escrow_timeout;
+				std::string part_number;
+				std::string serial_number;
+				std::uint64_t asset_number;
+				// at most 24 bill types
+				std::vector<bill_type> bill_table;
+				// the image replaced by DOWNLOAD and checked by GET CRC32,
+				// the boot loader writes it in blocks of 512 bytes
+				std::vector<std::uint8_t> firmware;
+			// the boot loader runs from DOWNLOAD until the image has been written
+			bool is_download_mode;
+			// the result of the last boot loader operation
+			std::uint8_t download_status;
+			std::vector<std::uint8_t> written_firmware;
+			};
+
+			explicit virtual_bill_validator(const configuration& device_configuration = configuration());
+
+			virtual_bill_validator(const virtual_bill_validator& other) = delete;
+
+			~virtual_bill_validator();
+
+			virtual_bill_validator& operator=(const virtual_bill_validator& other) = delete;
+
+			// the path of the serial port the host connects to
+			const std::string& get_port_name() const;
+
+			// the events are processed by the device on the following polls
+			void insert_bill(std::uint8_t bill_type_number);
+			void remove_cassette();
+			void insert_cassette();
+			void set_cassette_full(bool is_cassette_full);
+			void set_response_latency(std::chrono::microseconds response_latency);
+
+			// the number of commands received, confirmations excluded
+			std::size_t get_commands_count() const;
+
+		private:
+			void receive();
+			// whether the host has set the line to the configured baud rate
+			bool is_baud_rate_matching() const;
+			void process_frame(const frame& request);
+			// only the boot loader receives extended frames, the block writes
+			void process_extended_frame(const extended_frame& request);
+			void process_command(std::uint8_t code, const std::uint8_t* data, std::size_t data_size);
+			// the boot loader ignores the other commands
+			void process_download_subcommand(std::uint8_t subcommand, const std::uint8_t* data, std::size_t data_size);
+			// reports the state and moves on to the next one
+			void poll();
+			void respond(const std::uint8_t* data, std::size_t data_size);
+			void respond(std::uint8_t control_code);
+			void respond_extended(const std::uint8_t* data, std::size_t data_size);
+			void send(const extended_frame& response);
+			bool is_bill_type_set(const std::array<std::uint8_t, 3>& mask, std::uint8_t bill_type_number) const;
+			// whether the service commands are accepted: power up, initialization, failures or unit disabled
+			bool is_service_state() const;
+			// the state the device rests in when nothing happens
+			device_state_code get_rest_state() const;
+			void set_state(device_state_code code, std::uint8_t info = 0);
+			// increments a big-endian counter of the current statistics set, the counters saturate
+			void count(std::size_t offset, std::size_t size);
+
+		private:
+			const configuration device_configuration;
+			boost::asio::io_service io_service;
+			boost::asio::posix::stream_descriptor master;
+			// kept open so the master does not see a hang-up while the host reopens the port
+			int slave_descriptor;
+			std::string port_name;
+			boost::asio::steady_timer response_timer;
+			std::thread io_thread;
+			frame_parser parser;
+			// repeated on NAK, the responses of both kinds are kept as an extended frame
+			extended_frame last_response;
+			std::chrono::microseconds response_latency;
+			std::atomic<std::size_t> commands_count;
+			// the device state is only accessed from the I/O thread
+			device_state_code state;
+			std::uint8_t state_info;
+			std::chrono::steady_clock::time_point escrow_deadline;
+			std::deque<std::uint8_t> inserted_bills;
+			bool is_cassette_removed;
+			bool is_cassette_full;
+			// bit masks, the last byte holds bill types 0-7
+			std::array<std::uint8_t, 3> enabled_bill_types;
+			std::array<std::uint8_t, 3> escrow_bill_types;
+			std::array<std::uint8_t, 3> high_security_bill_types;
+			std::vector<std::uint8_t> firmware;
+			// the boot loader runs from DOWNLOAD until the image has been written
+			bool is_download_mode;
+			// the result of the last boot loader operation
+			std::uint8_t download_status;
+			std::vector<std::uint8_t> written_firmware;
+			// the REQUEST STATISTICS counters of the current set of 10000 inserted bills as they are sent,
+			// the earlier sets are never completed in a simulation
+			std::vector<std::uint8_t> statistics_set;
+	};
+
+}
+
+#endif // CCNET_VIRTUAL_BILL_VALIDATOR_H
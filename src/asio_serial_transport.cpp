@@ -0,0 +1,135 @@
+#include "asio_serial_transport.h"
+#include <condition_variable>
+#include <mutex>
+#include "request_pool.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <termios.h>
+#endif
+
+using namespace boost::asio;
+using namespace ccnet;
+
+// a single operation is started at a time:
+// the starting handler, the operation and the deadline wait
+const std::size_t handler_blocks_count = 4;
+const std::size_t handler_block_size = 512;
+
+serial_port::parity::type get_parity_type(connection_options::parity_type parity) {
+	switch (parity) {
+		case connection_options::parity_type::odd:
+			return serial_port::parity::odd;
+		case connection_options::parity_type::even:
+			return serial_port::parity::even;
+		default:
+			return serial_port::parity::none;
+	}
+}
+
+serial_port::stop_bits::type get_stop_bits_type(connection_options::stop_bits_type stop_bits) {
+	switch (stop_bits) {
+		case connection_options::stop_bits_type::one_point_five:
+			return serial_port::stop_bits::onepointfive;
+		case connection_options::stop_bits_type::two:
+			return serial_port::stop_bits::two;
+		default:
+			return serial_port::stop_bits::one;
+	}
+}
+
+asio_serial_transport::asio_serial_transport(boost::asio::io_service& io_service, const std::string& port_name) :
+	io_service(io_service),
+	serial_port(io_service, port_name),
+	deadline_timer(io_service),
+	handler_blocks(std::make_shared<block_pool>(handler_block_size, handler_blocks_count)) { }
+
+void asio_serial_transport::set_options(const connection_options& options) {
+	this->serial_port.set_option(serial_port::baud_rate(options.baud_rate));
+	this->serial_port.set_option(serial_port::character_size(options.character_size));
+	this->serial_port.set_option(serial_port::parity(get_parity_type(options.parity)));
+	this->serial_port.set_option(serial_port::stop_bits(get_stop_bits_type(options.stop_bits)));
+	this->serial_port.set_option(serial_port::flow_control(serial_port::flow_control::none));
+}
+
+void asio_serial_transport::set_baud_rate(std::uint32_t baud_rate) {
+	this->serial_port.set_option(serial_port::baud_rate(baud_rate));
+}
+
+template<typename AsyncOperation>
+bool asio_serial_transport::run(AsyncOperation operation, clock::duration timeout, std::size_t& transferred_size) {
+	std::mutex completion_mutex;
+	std::condition_variable completion_condition;
+	// the operation handler and the deadline handler
+	std::size_t pending_handlers_count = 2;
+	boost::system::error_code operation_error;
+	bool deadline_expired = false;
+
+	const auto complete_handler = [&completion_mutex, &completion_condition, &pending_handlers_count]() {
+		std::lock_guard<std::mutex> lock(completion_mutex);
+		--pending_handlers_count;
+		completion_condition.notify_one();
+	};
+
+	// the port and the timer are only accessed from the I/O thread,
+	// the memory of the handlers is taken from a preallocated pool
+	post(this->io_service, make_pooled_handler([&]() {
+		operation(make_pooled_handler([&](const boost::system::error_code& result, std::size_t size) {
+			this->deadline_timer.cancel();
+			operation_error = result;
+			transferred_size = size;
+			complete_handler();
+		}, this->handler_blocks));
+
+		this->deadline_timer.expires_after(timeout);
+		this->deadline_timer.async_wait(make_pooled_handler([&](const boost::system::error_code& result) {
+			if (!result) {
+				// abort the pending operation, its handler receives operation_aborted
+				deadline_expired = true;
+				this->serial_port.cancel();
+			}
+			complete_handler();
+		}, this->handler_blocks));
+	}, this->handler_blocks));
+
+	std::unique_lock<std::mutex> lock(completion_mutex);
+	completion_condition.wait(lock, [&pending_handlers_count]() { return pending_handlers_count == 0; });
+
+	if (deadline_expired && (operation_error == error::operation_aborted)) {
+		return false;
+	}
+
+	if (operation_error) {
+		throw boost::system::system_error(operation_error);
+	}
+
+	return true;
+}
+
+bool asio_serial_transport::write(const const_buffer& data, clock::duration timeout) {
+	std::size_t written_size = 0;
+
+	return this->run([this, &data](auto handler) {
+		async_write(this->serial_port, buffer(data), handler);
+	}, timeout, written_size);
+}
+
+std::size_t asio_serial_transport::read_some(const mutable_buffer& data, clock::duration timeout) {
+	std::size_t read_size = 0;
+
+	if (!this->run([this, &data](auto handler) {
+		this->serial_port.async_read_some(buffer(data), handler);
+	}, timeout, read_size)) {
+		return 0;
+	}
+
+	return read_size;
+}
+
+void asio_serial_transport::discard_input() {
+#ifdef _WIN32
+	::PurgeComm(this->serial_port.native_handle(), PURGE_RXABORT | PURGE_RXCLEAR);
+#else
+	::tcflush(this->serial_port.native_handle(), TCIFLUSH);
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef CCNET_ASIO_SERIAL_TRANSPORT_H
+#define CCNET_ASIO_SERIAL_TRANSPORT_H
+
+#include <memory>
+#include <string>
+#include <boost/asio.hpp>
+#include "serial_transport.h"
+
+namespace ccnet {
+
+	class block_pool;
+
+	// the portable transport on boost::asio::serial_port;
+	// the operations are asynchronous and completed by the thread running the io_service
+	class asio_serial_transport : public serial_transport {
+		public:
+			asio_serial_transport(boost::asio::io_service& io_service, const std::string& port_name);
+
+			asio_serial_transport(const asio_serial_transport& other) = delete;
+
+			asio_serial_transport& operator=(const asio_serial_transport& other) = delete;
+
+			void set_options(const connection_options& options) override;
+			void set_baud_rate(std::uint32_t baud_rate) override;
+
+			bool write(const boost::asio::const_buffer& data, clock::duration timeout) override;
+			std::size_t read_some(const boost::asio::mutable_buffer& data, clock::duration timeout) override;
+			void discard_input() override;
+
+		private:
+			template<typename AsyncOperation>
+			bool run(AsyncOperation operation, clock::duration timeout, std::size_t& transferred_size);
+
+		private:
+			boost::asio::io_service& io_service;
+			boost::asio::serial_port serial_port;
+			boost::asio::steady_timer deadline_timer;
+			// memory for the handler starting an operation on the I/O thread
+			std::shared_ptr<block_pool> handler_blocks;
+	};
+
+}
+
+#endif // CCNET_ASIO_SERIAL_TRANSPORT_H
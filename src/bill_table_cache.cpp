@@ -0,0 +1,155 @@
+#include "bill_table_cache.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include <boost/crc.hpp>
+#include "utility.h"
+
+using namespace ccnet;
+
+// the file layout, the integers are stored in little-endian byte order:
+// the format version, the entries count and the entries followed by the CRC32 of the bytes preceding it;
+// an entry is the serial number size, the serial number, the firmware CRC32, the bill types count
+// and the bill types made of the number, the denomination and the packed currency code
+const std::uint8_t cache_format_version = 1;
+
+// takes an integer of the size at the offset and moves past it,
+// throws if the data ends before the integer
+std::uint64_t take_uint(const std::vector<std::uint8_t>& data, std::size_t& offset, std::size_t size) {
+	if (data.size() - offset < size) {
+		throw std::runtime_error("invalid bill table cache");
+	}
+
+	const std::uint64_t value = load_uint(data.data() + offset, size);
+	offset += size;
+	return value;
+}
+
+void put_uint(std::vector<std::uint8_t>& data, std::uint64_t value, std::size_t size) {
+	data.resize(data.size() + size);
+	store_uint(data.data() + data.size() - size, value, size);
+}
+
+std::uint32_t get_data_crc(const std::vector<std::uint8_t>& data, std::size_t size) {
+	boost::crc_32_type crc;
+	crc.process_bytes(data.data(), size);
+	return crc.checksum();
+}
+
+bill_table_cache::bill_table_cache(const std::string& path) :
+	path(path),
+	entries_mutex(),
+	entries() {
+	std::ifstream file_stream(path, std::ios::binary);
+	if (!file_stream) {
+		// nothing has been cached yet
+		return;
+	}
+
+	const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file_stream)), std::istreambuf_iterator<char>());
+
+	try {
+		if (data.size() < sizeof(std::uint32_t)) {
+			throw std::runtime_error("invalid bill table cache");
+		}
+
+		const std::size_t crc_offset = data.size() - sizeof(std::uint32_t);
+		if (load_uint(data.data() + crc_offset, sizeof(std::uint32_t)) != get_data_crc(data, crc_offset)) {
+			throw std::runtime_error("invalid bill table cache");
+		}
+
+		std::size_t offset = 0;
+		if (take_uint(data, offset, sizeof(std::uint8_t)) != cache_format_version) {
+			throw std::runtime_error("invalid bill table cache");
+		}
+
+		const std::uint64_t entries_count = take_uint(data, offset, sizeof(std::uint32_t));
+		for (std::uint64_t i = 0; i < entries_count; ++i) {
+			const std::size_t serial_number_size = (std::size_t)take_uint(data, offset, sizeof(std::uint8_t));
+			if (crc_offset - offset < serial_number_size) {
+				throw std::runtime_error("invalid bill table cache");
+			}
+
+			const std::string serial_number(data.cbegin() + offset, data.cbegin() + offset + serial_number_size);
+			offset += serial_number_size;
+			const std::uint32_t firmware_crc32 = (std::uint32_t)take_uint(data, offset, sizeof(std::uint32_t));
+
+			std::map<std::uint8_t, cash_type>& bill_table = this->entries[entry_key(serial_number, firmware_crc32)];
+			const std::uint64_t bill_types_count = take_uint(data, offset, sizeof(std::uint8_t));
+			for (std::uint64_t j = 0; j < bill_types_count; ++j) {
+				const std::uint8_t bill_type_number = (std::uint8_t)take_uint(data, offset, sizeof(std::uint8_t));
+
+				cash_type& bill_type = bill_table[bill_type_number];
+				bill_type.denomination = take_uint(data, offset, sizeof(std::uint64_t));
+				bill_type.packed_currency_code = (std::uint32_t)take_uint(data, offset, sizeof(std::uint32_t));
+			}
+		}
+	} catch (std::exception) {
+		// the tables are read from the devices again
+		this->entries.clear();
+	}
+}
+
+bool bill_table_cache::find_bill_table(const std::string& serial_number, std::uint32_t firmware_crc32, std::map<std::uint8_t, cash_type>& bill_table) const {
+	std::lock_guard<std::mutex> lock(this->entries_mutex);
+
+	const std::map<entry_key, std::map<std::uint8_t, cash_type>>::const_iterator entry = this->entries.find(entry_key(serial_number, firmware_crc32));
+	if (entry == this->entries.cend()) {
+		return false;
+	}
+
+	bill_table = entry->second;
+	return true;
+}
+
+void bill_table_cache::store_bill_table(const std::string& serial_number, std::uint32_t firmware_crc32, const std::map<std::uint8_t, cash_type>& bill_table) {
+	if (serial_number.size() > 0xff) {
+		throw std::runtime_error("serial number is too long");
+	}
+
+	std::lock_guard<std::mutex> lock(this->entries_mutex);
+
+	// the entries of a device are ordered by the firmware CRC32 after its serial number
+	this->entries.erase(this->entries.lower_bound(entry_key(serial_number, 0)), this->entries.upper_bound(entry_key(serial_number, 0xffffffff)));
+	this->entries[entry_key(serial_number, firmware_crc32)] = bill_table;
+
+	this->save();
+}
+
+void bill_table_cache::save() const {
+	std::vector<std::uint8_t> data;
+
+	put_uint(data, cache_format_version, sizeof(std::uint8_t));
+	put_uint(data, this->entries.size(), sizeof(std::uint32_t));
+	for (std::map<entry_key, std::map<std::uint8_t, cash_type>>::const_iterator entry = this->entries.cbegin(); entry != this->entries.cend(); ++entry) {
+		put_uint(data, entry->first.first.size(), sizeof(std::uint8_t));
+		data.insert(data.end(), entry->first.first.cbegin(), entry->first.first.cend());
+		put_uint(data, entry->first.second, sizeof(std::uint32_t));
+
+		put_uint(data, entry->second.size(), sizeof(std::uint8_t));
+		for (std::map<std::uint8_t, cash_type>::const_iterator bill_type = entry->second.cbegin(); bill_type != entry->second.cend(); ++bill_type) {
+			put_uint(data, bill_type->first, sizeof(std::uint8_t));
+			put_uint(data, bill_type->second.denomination, sizeof(std::uint64_t));
+			put_uint(data, bill_type->second.packed_currency_code, sizeof(std::uint32_t));
+		}
+	}
+	put_uint(data, get_data_crc(data, data.size()), sizeof(std::uint32_t));
+
+	const std::string temporary_path = this->path + ".tmp";
+	{
+		std::ofstream file_stream(temporary_path, std::ios::binary | std::ios::trunc);
+		file_stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+		if (!file_stream) {
+			throw std::runtime_error("unable to write bill table cache");
+		}
+	}
+
+	// the renaming does not replace an existing file on every system
+	if ((std::rename(temporary_path.c_str(), this->path.c_str()) != 0)
+		&& ((std::remove(this->path.c_str()) != 0) || (std::rename(temporary_path.c_str(), this->path.c_str()) != 0))) {
+		throw std::runtime_error("unable to write bill table cache");
+	}
+}
@@ -0,0 +1,63 @@
+#include "bill_table_index.h"
+#include <stdexcept>
+
+using namespace ccnet;
+
+bill_table_index::bill_table_index() :
+	bill_types_by_numbers(std::make_shared<const std::map<std::uint8_t, cash_type>>()),
+	bill_types(),
+	bill_type_numbers() { }
+
+bill_table_index::bill_table_index(const std::map<std::uint8_t, cash_type>& bill_types_by_numbers) :
+	bill_types_by_numbers(std::make_shared<const std::map<std::uint8_t, cash_type>>(bill_types_by_numbers)),
+	bill_types(),
+	bill_type_numbers() {
+	this->bill_type_numbers.reserve(this->bill_types_by_numbers->size());
+
+	for (std::map<std::uint8_t, cash_type>::const_iterator iter = this->bill_types_by_numbers->cbegin(); iter != this->bill_types_by_numbers->cend(); ++iter) {
+		if (iter->first >= bill_types_count_max) {
+			throw std::runtime_error("invalid bill type number");
+		}
+
+		this->bill_types[iter->first] = &iter->second;
+		// the lowest number is kept for a cash type listed twice
+		this->bill_type_numbers.emplace(iter->second, iter->first);
+	}
+}
+
+const cash_type* bill_table_index::find_cash_type(std::uint8_t bill_type_number) const {
+	return (bill_type_number < bill_types_count_max) ? this->bill_types[bill_type_number] : nullptr;
+}
+
+bool bill_table_index::find_bill_type_number(const cash_type& bill_type, std::uint8_t& bill_type_number) const {
+	std::unordered_map<cash_type, std::uint8_t>::const_iterator iter = this->bill_type_numbers.find(bill_type);
+
+	if (iter == this->bill_type_numbers.cend()) {
+		return false;
+	}
+
+	bill_type_number = iter->second;
+	return true;
+}
+
+const cash_type& bill_table_index::get_cash_type(std::uint8_t bill_type_number) const {
+	const cash_type* bill_type = this->find_cash_type(bill_type_number);
+
+	if (bill_type == nullptr) {
+		throw std::runtime_error("unknown bill type");
+	}
+
+	return *bill_type;
+}
+
+const std::map<std::uint8_t, cash_type>& bill_table_index::get_bill_types_by_numbers() const {
+	return *this->bill_types_by_numbers;
+}
+
+const std::shared_ptr<const std::map<std::uint8_t, cash_type>>& bill_table_index::share_bill_types_by_numbers() const {
+	return this->bill_types_by_numbers;
+}
+
+bool bill_table_index::is_empty() const {
+	return this->bill_types_by_numbers->empty();
+}
@@ -0,0 +1,49 @@
+#ifndef CCNET_BILL_TABLE_INDEX_H
+#define CCNET_BILL_TABLE_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include "cash_type.h"
+
+namespace ccnet {
+
+	// the bidirectional mapping between the bill type numbers and the cash types
+	// built from the bill table; it is never modified after the construction,
+	// so a published index may be read from any thread
+	class bill_table_index {
+		public:
+			static const std::uint8_t bill_types_count_max = 24;
+
+			bill_table_index();
+			explicit bill_table_index(const std::map<std::uint8_t, cash_type>& bill_types_by_numbers);
+
+			bill_table_index(const bill_table_index& other) = delete;
+
+			bill_table_index& operator=(const bill_table_index& other) = delete;
+
+			// returns nullptr if the bill type is not in the table
+			const cash_type* find_cash_type(std::uint8_t bill_type_number) const;
+			// returns false if the cash type is not in the table
+			bool find_bill_type_number(const cash_type& bill_type, std::uint8_t& bill_type_number) const;
+			// like find_cash_type but throws if the bill type is not in the table
+			const cash_type& get_cash_type(std::uint8_t bill_type_number) const;
+
+			const std::map<std::uint8_t, cash_type>& get_bill_types_by_numbers() const;
+			// the same map, shared with the snapshots published while the index is current
+			const std::shared_ptr<const std::map<std::uint8_t, cash_type>>& share_bill_types_by_numbers() const;
+			bool is_empty() const;
+
+		private:
+			std::shared_ptr<const std::map<std::uint8_t, cash_type>> bill_types_by_numbers;
+			// point to the cash types held by the map above
+			std::array<const cash_type*, bill_types_count_max> bill_types;
+			std::unordered_map<cash_type, std::uint8_t> bill_type_numbers;
+	};
+
+}
+
+#endif // CCNET_BILL_TABLE_INDEX_H
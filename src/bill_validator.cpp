@@ -1,39 +1,48 @@
 #include "bill_validator.h"
-#include <exception>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+#include "bill_table_index.h"
+#include "bus.h"
+#include "codec.h"
+#include "firmware_image.h"
+#include "frame.h"
+#include "mpsc_queue.h"
+#include "protocol.h"
+#include "request_pool.h"
+#include "state_machine.h"
+#include "statistics_recorder.h"
 #include "utility.h"
 
 using namespace boost::asio;
 using namespace ccnet;
 
-#define POLYNOMIAL 0x08408
-
-const std::uint8_t byte_size = 8;
-
-// serial port parameters
-const serial_port::baud_rate baud_rate(9600);
-const serial_port::character_size char_size(8);
-const serial_port::parity parity(serial_port::parity::none);
-const serial_port::stop_bits stop_bits(serial_port::stop_bits::one);
-const serial_port::flow_control flow_ctrl(serial_port::flow_control::none);
-
-// acknowledge
-const std::uint8_t ack = 0x00;
-// negative acknowledge
-const std::uint8_t nak = 0xff;
-// illegal command
-const std::uint8_t ill_cmd = 0x30;
-
-const std::uint8_t sync = 0x02;
-const std::uint8_t bill_validator_addr = 0x03;
-
-// frame header structure
-const std::uint8_t header_size = 3; // in bytes
-const std::uint8_t sync_offset = 0;
-const std::uint8_t adr_offset = 1;
-const std::uint8_t lng_offset = 2;
-
-const std::uint64_t currency_base = 10;
-const std::uint8_t exponent_sign_bit_number = 7;
+// weight of a new sample in the average poll interval (1 / 2^shift)
+const std::uint8_t poll_interval_smoothing_shift = 3;
+
+// the default time the status is reused for
+const std::chrono::milliseconds default_status_cache_ttl(1000);
+
+// the DOWNLOAD subcommands
+const std::uint8_t download_request_status = 0x00;
+const std::uint8_t download_request_block_size = 0x01;
+const std::uint8_t download_write = 0x02;
+const std::uint8_t download_exit = 0x03;
+// the boot loader statuses
+const std::uint8_t download_ready = 0x00;
+const std::uint8_t download_succeeded = 0xe0;
+const std::uint8_t download_failed = 0xe1;
+const std::uint8_t download_crc_mismatch = 0xe2;
+// the boot loader acknowledges DOWNLOAD once it has started
+const std::chrono::milliseconds download_mode_timeout(200);
+// a written block follows its little-endian address in the image,
+// the blocks of 2^15 bytes are the largest fitting an extended frame
+const std::size_t download_address_size = 3;
+const std::uint8_t download_block_size_index_max = 15;
+
+// passed by reference
+const std::size_t bill_validator::request_block_size;
 
 bool bill_validator::device_state::operator==(const bill_validator::device_state& other) const {
 	return (this->code == other.code) && (this->info == other.info);
@@ -43,266 +52,697 @@ bool bill_validator::device_state::operator!=(const bill_validator::device_state
 	return !(*this == other);
 }
 
-bill_validator::bill_validator(const std::string& port_name, bill_validator_operator* bill_validator_operator) :
-	cmd_handler_thread(),
-	thread_is_working(false),
-	cmd_queue(),
-	cmd_queue_mutex(),
-	io_service(),
-	serial_port(io_service, port_name),
+bill_validator::bill_validator(const std::string& port_name, bill_validator_operator* bill_validator_operator, const poll_policy& policy, const escrow_policy& escrow, const connection_options& options, transaction_journal* journal, bill_table_cache* cache) :
+	owned_bus_manager(new bus_manager()),
+	device_bus_manager(owned_bus_manager.get()),
+	device_bus(nullptr),
+	device_address(default_device_address),
+	request_blocks(std::make_shared<block_pool>(request_block_size, cmd_queue_capacity * request_blocks_per_request)),
+	cmd_queue(new mpsc_queue<handler_command>(cmd_queue_capacity)),
+	device_statistics_recorder(new statistics_recorder()),
 	connected_device_operator(bill_validator_operator),
+	device_poll_policy(policy),
+	device_escrow_policy(escrow),
+	journal(journal),
+	cache(cache),
+	average_poll_interval(0),
+	initialization_required(true),
+	previous_device_state(),
+	current_device_state(),
+	previous_poll_time(),
+	next_poll_time(),
+	escrow_decision(),
+	escrow_bill_type_number(0),
+	escrow_decision_deadline(),
+	next_hold_time(),
 	connected_device_info(),
-	bill_types_by_numbers() {
-	try {
-		this->serial_port.set_option(baud_rate);
-		this->serial_port.set_option(char_size);
-		this->serial_port.set_option(parity);
-		this->serial_port.set_option(stop_bits);
-		this->serial_port.set_option(flow_ctrl);
-
-		this->thread_is_working = true;
-		this->cmd_handler_thread = std::thread(&bill_validator::operate, this);
-	} catch (boost::system::system_error) {
-		throw std::exception("serial port error");
-	} catch (std::system_error) {
-		throw std::exception("unable to create handler thread");
-	}
+	bill_types_index(std::make_shared<bill_table_index>()),
+	firmware_crc32(0),
+	bill_table_revalidation_required(false),
+	desired_enabled_bill_types(),
+	has_desired_enabled_bill_types(false),
+	desired_security_levels(),
+	has_desired_security_levels(false),
+	configuration_restore_required(false),
+	published_snapshot(),
+	status_cache_ttl(default_status_cache_ttl.count()),
+	is_status_cached(false),
+	cached_status(),
+	status_time(),
+	downloaded_image(),
+	downloaded_size(0),
+	firmware_result(nullptr),
+	download_mode_entered(false),
+	download_block_size(0),
+	next_statistics_time(),
+	statistics_supported(true),
+	collected_report(std::make_shared<statistics_report>()),
+	taken_report_mutex(),
+	taken_report(std::make_shared<statistics_report>()) {
+	this->publish_snapshot(false);
+	this->attach(port_name, options);
+}
+
+bill_validator::bill_validator(bus_manager& manager, const std::string& port_name, std::uint8_t device_address, bill_validator_operator* bill_validator_operator, const poll_policy& policy, const escrow_policy& escrow, const connection_options& options, transaction_journal* journal, bill_table_cache* cache) :
+	owned_bus_manager(),
+	device_bus_manager(&manager),
+	device_bus(nullptr),
+	device_address(device_address),
+	request_blocks(std::make_shared<block_pool>(request_block_size, cmd_queue_capacity * request_blocks_per_request)),
+	cmd_queue(new mpsc_queue<handler_command>(cmd_queue_capacity)),
+	device_statistics_recorder(new statistics_recorder()),
+	connected_device_operator(bill_validator_operator),
+	device_poll_policy(policy),
+	device_escrow_policy(escrow),
+	journal(journal),
+	cache(cache),
+	average_poll_interval(0),
+	initialization_required(true),
+	previous_device_state(),
+	current_device_state(),
+	previous_poll_time(),
+	next_poll_time(),
+	escrow_decision(),
+	escrow_bill_type_number(0),
+	escrow_decision_deadline(),
+	next_hold_time(),
+	connected_device_info(),
+	bill_types_index(std::make_shared<bill_table_index>()),
+	firmware_crc32(0),
+	bill_table_revalidation_required(false),
+	desired_enabled_bill_types(),
+	has_desired_enabled_bill_types(false),
+	desired_security_levels(),
+	has_desired_security_levels(false),
+	configuration_restore_required(false),
+	published_snapshot(),
+	status_cache_ttl(default_status_cache_ttl.count()),
+	is_status_cached(false),
+	cached_status(),
+	status_time(),
+	downloaded_image(),
+	downloaded_size(0),
+	firmware_result(nullptr),
+	download_mode_entered(false),
+	download_block_size(0),
+	next_statistics_time(),
+	statistics_supported(true),
+	collected_report(std::make_shared<statistics_report>()),
+	taken_report_mutex(),
+	taken_report(std::make_shared<statistics_report>()) {
+	this->publish_snapshot(false);
+	this->attach(port_name, options);
 }
 
 bill_validator::~bill_validator() {
-	this->thread_is_working = false;
-	this->cmd_handler_thread.join();
+	this->device_bus_manager->detach(this->device_bus, this);
+
+	// fail the requests which have not been processed
+	handler_command pending_command;
+	while (this->cmd_queue->try_pop(pending_command)) {
+		pending_command.result->fail(std::make_exception_ptr(std::runtime_error("bill validator is destroyed")));
+		this->release_request(pending_command.result);
+	}
+
+	if (this->firmware_result != nullptr) {
+		this->firmware_result->fail(std::make_exception_ptr(std::runtime_error("bill validator is destroyed")));
+		this->release_request(this->firmware_result);
+	}
 }
 
 std::future<device_info> bill_validator::get_device_info() {
-	std::promise<device_info>* promised_result = new std::promise<device_info>();
-	handler_command new_command(handler_command_code::get_device_info, std::vector<std::uint8_t>(), promised_result);
+	return this->push_request<device_info>(handler_command_code::get_device_info, nullptr, 0);
+}
 
-	this->cmd_queue_mutex.lock();
-	this->cmd_queue.push(new_command);
-	this->cmd_queue_mutex.unlock();
+std::future<std::set<cash_type>> bill_validator::get_enabled_cash_types() {
+	return this->push_request<std::set<cash_type>>(handler_command_code::get_enabled_bill_types, nullptr, 0);
+}
 
-	return promised_result->get_future();
+std::future<void> bill_validator::set_enabled_cash_types(const std::set<cash_type>& enabled_bill_types) {
+	handler_command_data command_data = {};
+	this->encode_enabled_cash_types(enabled_bill_types, command_data);
+
+	return this->push_request<void>(handler_command_code::set_enabled_bill_types, command_data.data(), enable_bill_types_command_data_size);
 }
 
-std::future<std::set<cash_type>> bill_validator::get_enabled_cash_types() {
-	std::promise<std::set<cash_type>>* promised_result = new std::promise<std::set<cash_type>>();
-	handler_command new_command(handler_command_code::get_enabled_bill_types, std::vector<std::uint8_t>(), promised_result);
+std::future<std::map<cash_type, bill_security_level>> bill_validator::get_cash_types_security_levels() {
+	return this->push_request<std::map<cash_type, bill_security_level>>(handler_command_code::get_bill_types_security_levels, nullptr, 0);
+}
 
-	this->cmd_queue_mutex.lock();
-	this->cmd_queue.push(new_command);
-	this->cmd_queue_mutex.unlock();
+std::future<void> bill_validator::set_cash_types_security_levels(const std::map<cash_type, bill_security_level>& security_levels) {
+	handler_command_data command_data = {};
+	this->encode_cash_types_security_levels(security_levels, command_data);
 
-	return promised_result->get_future();
+	return this->push_request<void>(handler_command_code::set_bill_types_security_levels, command_data.data(), set_security_command_data_size);
 }
 
-std::future<void> bill_validator::set_enabled_cash_types(const std::set<cash_type>& enabled_bill_types) {
-	std::vector<std::uint8_t> command_data(enable_bill_types_command_data_size);
-	std::uint8_t bill_type_number = 0;
+std::future<std::set<cash_type>> bill_validator::get_cash_types() {
+	return this->push_request<std::set<cash_type>>(handler_command_code::get_bill_types, nullptr, 0);
+}
 
-	for (std::set<cash_type>::const_iterator iter = enabled_bill_types.cbegin(); iter != enabled_bill_types.cend(); ++iter) {
-		std::map<std::uint8_t, cash_type>::const_iterator cash_type_iter = std::find_if(this->bill_types_by_numbers.cbegin(), this->bill_types_by_numbers.cend(),
-			[iter](std::pair<std::uint8_t, cash_type> p) { return p.second == *iter; });
+std::future<firmware_update_result> bill_validator::update_firmware(const std::string& image_path, const firmware_progress_handler& progress_handler) {
+	return this->push_request<firmware_update_result>(handler_command_code::update_firmware, nullptr, 0, open_firmware_image(image_path, progress_handler));
+}
+
+std::shared_ptr<const device_snapshot> bill_validator::get_snapshot() const {
+	return std::atomic_load(&this->published_snapshot);
+}
+
+double bill_validator::get_poll_rate() const {
+	const std::int64_t poll_interval = this->average_poll_interval.load(std::memory_order_relaxed);
 
-		if (cash_type_iter == this->bill_types_by_numbers.cend()) {
-			throw std::exception("specified cash type is not supported");
+	return (poll_interval > 0) ? (1000000.0 / poll_interval) : 0.0;
+}
+
+device_statistics bill_validator::get_statistics() const {
+	return this->device_statistics_recorder->get_snapshot();
+}
+
+device_counters bill_validator::take_device_counters() {
+	const std::shared_ptr<const statistics_report> report = std::atomic_load(&this->collected_report);
+
+	std::lock_guard<std::mutex> lock(this->taken_report_mutex);
+	const device_counters delta = get_counters_delta(*report, *this->taken_report);
+	this->taken_report = report;
+
+	return delta;
+}
+
+void bill_validator::set_status_cache_ttl(std::chrono::milliseconds ttl) {
+	this->status_cache_ttl.store(ttl.count(), std::memory_order_relaxed);
+}
+
+void bill_validator::attach(const std::string& port_name, const connection_options& options) {
+	try {
+		this->device_bus_manager->attach(port_name, options, this);
+	} catch (boost::system::system_error) {
+		throw std::runtime_error("serial port error");
+	}
+}
+
+std::chrono::steady_clock::time_point bill_validator::step() {
+	try {
+		const std::chrono::steady_clock::time_point poll_time = std::chrono::steady_clock::now();
+
+		if (poll_time < this->next_poll_time) {
+			// woken up to process a host command before the next poll
+			this->process_command();
+			return this->next_poll_time;
+		}
+
+		if (this->downloaded_image) {
+			// the blocks follow each other as soon as the line is free
+			this->download_firmware_block();
+			this->next_poll_time = std::chrono::steady_clock::now();
+			return this->next_poll_time;
+		}
+
+		if (this->download_mode_entered) {
+			// the boot loader ignores the polls, the device waits for the download to be retried
+			this->process_command();
+			this->next_poll_time = poll_time + this->device_poll_policy.watchdog_interval;
+			return this->next_poll_time;
+		}
+
+		if (this->initialization_required) {
+			this->initialize();
 		}
 
-		bill_type_number = cash_type_iter->first;
-		set_bit(command_data[3 - (bill_type_number / byte_size)], bill_type_number % byte_size);
-		set_bit(command_data[3 - (bill_type_number / byte_size) + 3], bill_type_number % byte_size);
+		if (this->previous_poll_time != std::chrono::steady_clock::time_point()) {
+			const std::int64_t poll_interval = std::chrono::duration_cast<std::chrono::microseconds>(poll_time - this->previous_poll_time).count();
+			const std::int64_t average_poll_interval = this->average_poll_interval.load(std::memory_order_relaxed);
+			this->average_poll_interval.store((average_poll_interval == 0)
+				? poll_interval
+				: average_poll_interval + ((poll_interval - average_poll_interval) >> poll_interval_smoothing_shift), std::memory_order_relaxed);
+		}
+		this->previous_poll_time = poll_time;
+
+		this->previous_device_state = this->current_device_state;
+		this->current_device_state = this->poll();
+
+		if (this->current_device_state != this->previous_device_state) {
+			this->record_journal_event(journal_event::state_changed, this->current_device_state);
+			this->publish_snapshot(true);
+		}
+
+		// the next poll time depends on the reported state
+		this->next_poll_time = poll_time + this->device_poll_policy.get_interval(this->current_device_state.code);
+
+		if (this->previous_device_state.code != this->current_device_state.code) {
+			this->dispatch_state_transition();
+
+			if (this->initialization_required) {
+				// reinitialize right away instead of talking to the device
+				return this->next_poll_time;
+			}
+		}
+
+		if (this->configuration_restore_required
+			&& ((this->current_device_state.code == device_state_code::idling) || (this->current_device_state.code == device_state_code::unit_disabled))) {
+			this->restore_configuration();
+		}
+
+		if (this->escrow_decision.valid()) {
+			this->process_escrow_decision();
+		}
+
+		if (this->is_statistics_due(poll_time)) {
+			this->collect_statistics();
+		} else if (this->bill_table_revalidation_required && this->is_service_slot()) {
+			this->revalidate_bill_table();
+		}
+
+		this->process_command();
+
+		return this->next_poll_time;
+	} catch (std::exception) {
+		// reinitialize the bill validator after a while
+		if (!this->initialization_required) {
+			this->publish_snapshot(false);
+		}
+		this->initialization_required = true;
+		this->next_poll_time = std::chrono::steady_clock::now() + this->device_poll_policy.watchdog_interval;
+		return this->next_poll_time;
 	}
+}
 
-	std::promise<void>* promised_result = new std::promise<void>();
-	handler_command new_command(handler_command_code::set_enabled_bill_types, command_data, promised_result);
+template<typename T>
+std::future<T> bill_validator::push_request(handler_command_code code, const std::uint8_t* data, std::size_t data_size, std::shared_ptr<const firmware_image> image) {
+	promise_request<T>* pending_request = new (this->allocate_request(sizeof(promise_request<T>))) promise_request<T>(this->request_blocks);
+	std::future<T> future_result = pending_request->promise.get_future();
+	handler_command new_command(code, data, data_size, pending_request, std::move(image));
 
-	this->cmd_queue_mutex.lock();
-	this->cmd_queue.push(new_command);
-	this->cmd_queue_mutex.unlock();
+	if (!this->push_command(new_command)) {
+		this->release_request(pending_request);
+		throw std::runtime_error("command queue is full");
+	}
 
-	return promised_result->get_future();
+	return future_result;
 }
 
-std::future<std::map<cash_type, bill_security_level>> bill_validator::get_cash_types_security_levels() {
-	std::promise<std::map<cash_type, bill_security_level>>* promised_result = new std::promise<std::map<cash_type, bill_security_level>>();
-	handler_command new_command(handler_command_code::get_bill_types_security_levels, std::vector<std::uint8_t>(), promised_result);
+std::shared_ptr<const firmware_image> bill_validator::open_firmware_image(const std::string& image_path, const firmware_progress_handler& progress_handler) {
+	return std::make_shared<firmware_image>(image_path, progress_handler);
+}
 
-	this->cmd_queue_mutex.lock();
-	this->cmd_queue.push(new_command);
-	this->cmd_queue_mutex.unlock();
+void* bill_validator::allocate_request(std::size_t size) {
+	void* request_memory = this->request_blocks->allocate(size);
 
-	return promised_result->get_future();
+	return (request_memory != nullptr) ? request_memory : ::operator new(size);
 }
 
-std::future<void> bill_validator::set_cash_types_security_levels(const std::map<cash_type, bill_security_level>& security_levels) {
-	std::vector<std::uint8_t> command_data(set_security_command_data_size);
+void bill_validator::release_request(request* pending_request) {
+	pending_request->~request();
+
+	if (!this->request_blocks->deallocate(pending_request)) {
+		::operator delete(pending_request);
+	}
+}
+
+void bill_validator::encode_enabled_cash_types(const std::set<cash_type>& enabled_bill_types, handler_command_data& command_data) const {
+	const std::shared_ptr<const bill_table_index> bill_types = std::atomic_load(&this->bill_types_index);
+	std::uint8_t bill_type_number = 0;
+
+	for (std::set<cash_type>::const_iterator iter = enabled_bill_types.cbegin(); iter != enabled_bill_types.cend(); ++iter) {
+		if (!bill_types->find_bill_type_number(*iter, bill_type_number)) {
+			throw std::runtime_error("specified cash type is not supported");
+		}
+
+		// the enabled bill types are held in escrow
+		set_bill_type_bit(command_data.data(), bill_type_number);
+		set_bill_type_bit(command_data.data() + bill_types_mask_size, bill_type_number);
+	}
+}
+
+void bill_validator::encode_cash_types_security_levels(const std::map<cash_type, bill_security_level>& security_levels, handler_command_data& command_data) const {
+	const std::shared_ptr<const bill_table_index> bill_types = std::atomic_load(&this->bill_types_index);
 	std::uint8_t bill_type_number = 0;
 
 	for (std::map<cash_type, bill_security_level>::const_iterator iter = security_levels.cbegin(); iter != security_levels.cend(); ++iter) {
+		if (!bill_types->find_bill_type_number(iter->first, bill_type_number)) {
+			throw std::runtime_error("specified cash type is not supported");
+		}
+
 		if (iter->second == bill_security_level::high) {
-			std::map<std::uint8_t, cash_type>::const_iterator cash_type_iter = std::find_if(this->bill_types_by_numbers.cbegin(), this->bill_types_by_numbers.cend(),
-				[iter](std::pair<std::uint8_t, cash_type> p) { return p.second == iter->first; });
+			set_bill_type_bit(command_data.data(), bill_type_number);
+		}
+	}
+}
 
-			if (cash_type_iter == this->bill_types_by_numbers.cend()) {
-				throw std::exception("specified cash type is not supported");
-			}
+bool bill_validator::push_command(handler_command& command) {
+	if (!this->cmd_queue->try_push(std::move(command))) {
+		return false;
+	}
 
-			bill_type_number = cash_type_iter->first;
-			set_bit(command_data[bill_type_number / byte_size], bill_type_number);
-		}
+	// process the command right after the current exchange
+	this->device_bus_manager->notify();
+	return true;
+}
+
+bool bill_validator::has_pending_commands() const {
+	return !this->cmd_queue->is_empty();
+}
+
+void bill_validator::process_command() {
+	handler_command current_command;
+
+	if (!this->cmd_queue->try_pop(current_command)) {
+		return;
 	}
 
-	std::promise<void>* promised_result = new std::promise<void>();
-	handler_command new_command(handler_command_code::set_bill_types_security_levels, command_data, promised_result);
+	if (this->download_mode_entered && (current_command.code != handler_command_code::update_firmware)) {
+		current_command.result->fail(std::make_exception_ptr(std::runtime_error("bill validator is in download mode")));
+		this->release_request(current_command.result);
+		return;
+	}
 
-	this->cmd_queue_mutex.lock();
-	this->cmd_queue.push(new_command);
-	this->cmd_queue_mutex.unlock();
+	const frame data(current_command.data.data(), current_command.data.data() + current_command.data_size);
 
-	return promised_result->get_future();
+	switch (current_command.code) {
+		case handler_command_code::get_bill_types: {
+			this->get_bill_types_handler(data, current_command.result);
+			break;
+		}
+		case handler_command_code::get_bill_types_security_levels: {
+			this->get_bill_types_security_levels_handler(current_command.push_time, current_command.result);
+			break;
+		}
+		case handler_command_code::get_device_info: {
+			this->get_device_info_handler(data, current_command.result);
+			break;
+		}
+		case handler_command_code::get_enabled_bill_types: {
+			this->get_enabled_bill_types_handler(current_command.push_time, current_command.result);
+			break;
+		}
+		case handler_command_code::set_bill_types_security_levels: {
+			this->set_bill_types_security_levels_handler(data, current_command.result);
+			break;
+		}
+		case handler_command_code::set_enabled_bill_types: {
+			this->set_enabled_bill_types_handler(data, current_command.result);
+			break;
+		}
+		case handler_command_code::update_firmware: {
+			this->update_firmware_handler(std::move(current_command.image), current_command.result);
+			break;
+		}
+	}
 }
 
-std::future<std::set<cash_type>> bill_validator::get_cash_types() {
-	std::promise<std::set<cash_type>>* promised_result = new std::promise<std::set<cash_type>>();
-	handler_command new_command(handler_command_code::get_bill_types, std::vector<std::uint8_t>(), promised_result);
+void bill_validator::initialize() {
+	// the reset returns the bill in escrow and disables all the bill types
+	this->escrow_decision = std::future<cash_action>();
+	this->invalidate_status();
+
+	if (!this->device_bus->is_baud_rate_locked()) {
+		this->detect_baud_rate();
+	}
+
+	// the reset clears the power up state telling a bill has been left in the device
+	const device_state power_up_state = this->poll();
+	if ((power_up_state.code == device_state_code::power_up_with_bill_in_val) || (power_up_state.code == device_state_code::power_up_with_bill_in_stack)) {
+		this->record_journal_event(journal_event::power_up_with_bill, power_up_state);
+	}
 
-	this->cmd_queue_mutex.lock();
-	this->cmd_queue.push(new_command);
-	this->cmd_queue_mutex.unlock();
+	this->reset();
+	this->connected_device_info = this->request_device_info();
+	this->replace_bill_table(this->request_cached_bill_table());
 
-	return promised_result->get_future();
+	// init completed, the reset has cleared the configuration set by the host
+	this->initialization_required = false;
+	this->configuration_restore_required = true;
+	// the first statistics are read an interval later, not in the slot after the initialization
+	this->next_statistics_time = std::chrono::steady_clock::now() + this->device_poll_policy.statistics_interval;
+	this->publish_snapshot(true);
 }
 
-void bill_validator::operate() {
-	device_state previous_device_state;
-	device_state current_device_state;
-	bool initialization_required = true;
+bool bill_validator::is_operational_state(device_state_code code) {
+	switch (code) {
+		case device_state_code::initialize:
+		case device_state_code::idling:
+		case device_state_code::accepting:
+		case device_state_code::stacking:
+		case device_state_code::returning:
+		case device_state_code::unit_disabled:
+		case device_state_code::holding:
+		case device_state_code::device_busy:
+		case device_state_code::rejecting: {
+			return true;
+		}
+		default: {
+			// the device has been reset or has failed
+			return false;
+		}
+	}
+}
 
-	while (this->thread_is_working) {
-		this->reset();
-		this->connected_device_info = this->request_device_info();
-		this->bill_types_by_numbers = this->request_bill_table();
+bool bill_validator::is_service_state(device_state_code code) {
+	switch (code) {
+		case device_state_code::power_up:
+		case device_state_code::power_up_with_bill_in_val:
+		case device_state_code::power_up_with_bill_in_stack:
+		case device_state_code::initialize:
+		case device_state_code::unit_disabled:
+		case device_state_code::drop_cassette_full:
+		case device_state_code::drop_cassette_out_of_pos:
+		case device_state_code::validator_jammed:
+		case device_state_code::drop_cassette_jammed:
+		case device_state_code::cheated:
+		case device_state_code::pause:
+		case device_state_code::failure: {
+			return true;
+		}
+		default: {
+			return false;
+		}
+	}
+}
 
-		// init completed
-		initialization_required = false;
+void bill_validator::restore_configuration() {
+	this->configuration_restore_required = false;
 
-		while ((this->thread_is_working) && (!initialization_required)) {
-			previous_device_state = current_device_state;
-			current_device_state = this->poll();
+	if ((!this->has_desired_enabled_bill_types) && (!this->has_desired_security_levels)) {
+		return;
+	}
 
-			if (previous_device_state.code != current_device_state.code) {
-				switch (previous_device_state.code) {
-					case device_state_code::drop_cassette_out_of_pos: {
-						this->connected_device_operator->drop_cassette_installed();
-						initialization_required = true;
-						continue; // return to outer cycle
-					}
-				}
+	frame status;
+	this->invalidate_status();
+	this->request_status(std::chrono::steady_clock::now(), status);
 
-				switch (current_device_state.code) {
-					case device_state_code::drop_cassette_full: {
-						this->connected_device_operator->drop_cassette_full();
-						break;
-					}
-					case device_state_code::drop_cassette_out_of_pos: {
-						this->connected_device_operator->drop_cassette_removed();
-						break;
-					}
-					case device_state_code::validator_jammed:
-					case device_state_code::drop_cassette_jammed: {
-						// TODO
-					}
-					case device_state_code::failure: {
-						// TODO
-					}
-					case device_state_code::escrow_pos: {
-						std::future<cash_action> future_result = this->connected_device_operator->request_cash_action(this->bill_types_by_numbers.at(current_device_state.info));
-
-						if (future_result.wait_for(std::chrono::seconds(10)) == std::future_status::timeout) {
-							this->return_bill();
-						}
-
-						switch (future_result.get()) {
-							case cash_action::accept_cash: {
-								this->stack_bill();
-								break;
-							}
-							case cash_action::hold_cash: {
-								// TODO: redesign escrow_pos state handling using inner poll() loop
-								current_device_state = device_state(device_state_code::idling, 0); // small hack to repeat cash action request
-								this->hold_bill();
-								break;
-							}
-							case cash_action::return_cash: {
-								this->return_bill();
-								break;
-							}
-						}
-
-						break;
-					}
-					case device_state_code::bill_stacked: {
-						this->connected_device_operator->cash_accepted(this->bill_types_by_numbers.at(current_device_state.info));
-						break;
-					}
-					case device_state_code::bill_returned: {
-						this->connected_device_operator->cash_returned(this->bill_types_by_numbers.at(current_device_state.info));
-						break;
-					}
-				}
-			}
+	// the security levels go first, so no bill is accepted at the levels the device has fallen back to;
+	// the first masks of the GET STATUS response are compared, the escrow mask is not reported
+	bool is_configuration_sent = false;
 
-			this->cmd_queue_mutex.lock();
-			if (!this->cmd_queue.empty()) {
-				handler_command current_command = this->cmd_queue.front();
-				this->cmd_queue.pop();
-				this->cmd_queue_mutex.unlock();
-
-				switch (current_command.code) {
-					case handler_command_code::get_bill_types: {
-						this->get_bill_types_handler(current_command.data, current_command.result);
-						break;
-					}
-					case handler_command_code::get_bill_types_security_levels: {
-						this->get_bill_types_security_levels_handler(current_command.data, current_command.result);
-						break;
-					}
-					case handler_command_code::get_device_info: {
-						this->get_device_info_handler(current_command.data, current_command.result);
-						break;
-					}
-					case handler_command_code::get_enabled_bill_types: {
-						this->get_enabled_bill_types_handler(current_command.data, current_command.result);
-						break;
-					}
-					case handler_command_code::set_bill_types_security_levels: {
-						this->set_bill_types_security_levels_handler(current_command.data, current_command.result);
-						break;
-					}
-					case handler_command_code::set_enabled_bill_types: {
-						this->set_enabled_bill_types_handler(current_command.data, current_command.result);
-						break;
-					}
-				}
-			} else {
-				this->cmd_queue_mutex.unlock();
+	if (this->has_desired_security_levels && (!std::equal(this->desired_security_levels.cbegin(), this->desired_security_levels.cbegin() + bill_types_mask_size, status.cbegin() + bill_types_mask_size))) {
+		const device_command set_security_command(device_command_code::set_security, this->desired_security_levels.data(), set_security_command_data_size);
+		this->send_command(set_security_command);
+		is_configuration_sent = true;
+	}
+
+	if (this->has_desired_enabled_bill_types && (!std::equal(this->desired_enabled_bill_types.cbegin(), this->desired_enabled_bill_types.cbegin() + bill_types_mask_size, status.cbegin()))) {
+		const device_command enable_bill_types_command(device_command_code::enable_bill_types, this->desired_enabled_bill_types.data(), enable_bill_types_command_data_size);
+		this->send_command(enable_bill_types_command);
+		is_configuration_sent = true;
+	}
+
+	if (is_configuration_sent) {
+		this->invalidate_status();
+	}
+}
+
+void bill_validator::replace_bill_table(const std::map<std::uint8_t, cash_type>& bill_table) {
+	if (bill_table == this->bill_types_index->get_bill_types_by_numbers()) {
+		return;
+	}
+
+	// the masks refer to the bill type numbers of the previous table
+	this->has_desired_enabled_bill_types = false;
+	this->has_desired_security_levels = false;
+	std::atomic_store(&this->bill_types_index, std::shared_ptr<const bill_table_index>(std::make_shared<bill_table_index>(bill_table)));
+}
+
+void bill_validator::detect_baud_rate() {
+	std::vector<std::uint32_t> baud_rates(this->device_bus->get_options().probe_baud_rates);
+	std::sort(baud_rates.begin(), baud_rates.end(), std::greater<std::uint32_t>());
+
+	for (std::vector<std::uint32_t>::const_iterator iter = baud_rates.cbegin(); iter != baud_rates.cend(); ++iter) {
+		try {
+			this->device_bus->set_baud_rate(*iter);
+
+			if (!this->probe_baud_rate()) {
+				continue;
 			}
+		} catch (std::exception) {
+			// the port does not support the rate
+			continue;
+		}
+
+		this->device_bus->lock_baud_rate();
+		return;
+	}
+
+	throw std::runtime_error("device does not respond at any of the baud rates");
+}
+
+bool bill_validator::probe_baud_rate() {
+	const device_command poll_command(device_command_code::poll);
+	frame command_frame;
+	this->build_command_frame(poll_command, command_frame);
+
+	this->device_bus->write_frame(command_frame);
+
+	std::uint8_t response_address = 0;
+	frame payload;
+	if (!this->device_bus->read_frame(response_address, payload, *this->device_statistics_recorder)) {
+		// no frame or only the garbage of a mismatched rate
+		return false;
+	}
+
+	// the state is confirmed, so the device does not repeat it; the control packets are not confirmed
+	const bool is_control_packet = (payload.size() == 1) && ((payload[0] == ack) || (payload[0] == nak) || (payload[0] == ill_cmd));
+	if ((response_address == this->device_address) && (!is_control_packet)) {
+		this->device_bus->send_ack(response_address);
+	}
 
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	return true;
+}
+
+void bill_validator::dispatch_state_transition() {
+	typedef state_machine<bill_validator> device_state_machine;
+
+	// the states without hooks (the jams and the failure among them) are only published
+	static constexpr device_state_machine::state_hooks hooks[] = {
+		{ device_state_code::power_up, &bill_validator::enter_power_up, nullptr },
+		{ device_state_code::power_up_with_bill_in_val, &bill_validator::enter_power_up_with_bill, nullptr },
+		{ device_state_code::power_up_with_bill_in_stack, &bill_validator::enter_power_up_with_bill, nullptr },
+		{ device_state_code::drop_cassette_full, &bill_validator::enter_drop_cassette_full, nullptr },
+		{ device_state_code::drop_cassette_out_of_pos, &bill_validator::enter_drop_cassette_out_of_pos, &bill_validator::exit_drop_cassette_out_of_pos },
+		{ device_state_code::escrow_pos, &bill_validator::enter_escrow_pos, nullptr },
+		{ device_state_code::bill_stacked, &bill_validator::enter_bill_stacked, nullptr },
+		{ device_state_code::bill_returned, &bill_validator::enter_bill_returned, nullptr }
+	};
+
+	static constexpr device_state_machine::transition transitions[] = {
+		{ device_state_code::holding, device_state_code::escrow_pos, &bill_validator::resume_escrow }
+	};
+
+	static constexpr device_state_machine machine(hooks, transitions);
+
+	machine.dispatch(*this, this->previous_device_state.code, this->current_device_state.code);
+}
+
+bool bill_validator::enter_power_up() {
+	// the device has been reset on its own
+	this->invalidate_status();
+	return true;
+}
+
+bool bill_validator::enter_power_up_with_bill() {
+	// the bill has to be reconciled by the operator from the journal
+	this->record_journal_event(journal_event::power_up_with_bill, this->current_device_state);
+	this->invalidate_status();
+	return true;
+}
+
+bool bill_validator::enter_drop_cassette_full() {
+	this->connected_device_operator->drop_cassette_full();
+	return true;
+}
+
+bool bill_validator::enter_drop_cassette_out_of_pos() {
+	this->connected_device_operator->drop_cassette_removed();
+	return true;
+}
+
+bool bill_validator::exit_drop_cassette_out_of_pos() {
+	this->connected_device_operator->drop_cassette_installed();
+
+	if (!is_operational_state(this->current_device_state.code)) {
+		this->initialization_required = true;
+		this->next_poll_time = std::chrono::steady_clock::now();
+		return false;
+	}
+
+	// the device goes on without a reset, the configuration is checked once it rests
+	this->invalidate_status();
+	this->configuration_restore_required = true;
+	return true;
+}
+
+bool bill_validator::enter_escrow_pos() {
+	this->record_journal_event(journal_event::bill_escrowed, this->current_device_state);
+	this->escrow_bill_type_number = this->current_device_state.info;
+	this->request_escrow_decision();
+	return true;
+}
+
+bool bill_validator::enter_bill_stacked() {
+	this->record_journal_event(journal_event::bill_stacked, this->current_device_state);
+	this->connected_device_operator->cash_accepted(this->bill_types_index->get_cash_type(this->current_device_state.info));
+	return true;
+}
+
+bool bill_validator::enter_bill_returned() {
+	this->record_journal_event(journal_event::bill_returned, this->current_device_state);
+	this->connected_device_operator->cash_returned(this->bill_types_index->get_cash_type(this->current_device_state.info));
+	return true;
+}
+
+bool bill_validator::resume_escrow() {
+	// the bill is escrowed anew only if the decision on it is over
+	return !this->escrow_decision.valid();
+}
+
+void bill_validator::record_journal_event(journal_event event, const device_state& state) {
+	if (this->journal == nullptr) {
+		return;
+	}
+
+	journal_record record;
+	record.device_address = this->device_address;
+	record.event = event;
+	record.state = state.code;
+	record.state_info = state.info;
+
+	if ((event != journal_event::state_changed) && (event != journal_event::power_up_with_bill)) {
+		const cash_type* cash = this->bill_types_index->find_cash_type(state.info);
+
+		if (cash != nullptr) {
+			record.cash = *cash;
 		}
 	}
+
+	try {
+		this->journal->append(record);
+	} catch (std::exception) {
+		// a disk failure is not a device failure, the device is not reinitialized for it
+		this->device_statistics_recorder->increment(statistics_recorder::counter::journal_errors);
+	}
+}
+
+void bill_validator::publish_snapshot(bool is_initialized) {
+	std::shared_ptr<device_snapshot> snapshot = std::make_shared<device_snapshot>();
+	snapshot->is_initialized = is_initialized;
+	snapshot->info = this->connected_device_info;
+	snapshot->bill_table = this->bill_types_index->share_bill_types_by_numbers();
+	snapshot->state = this->current_device_state.code;
+	snapshot->state_info = this->current_device_state.info;
+	snapshot->update_time = std::chrono::steady_clock::now();
+
+	std::atomic_store(&this->published_snapshot, std::shared_ptr<const device_snapshot>(std::move(snapshot)));
 }
 
 void bill_validator::reset() {
-	device_command reset_command(device_command_code::reset, std::vector<std::uint8_t>());
+	device_command reset_command(device_command_code::reset);
 
 	this->send_command(reset_command);
 }
 
 bill_validator::device_state bill_validator::poll() {
-	device_command poll_command(device_command_code::poll, std::vector<std::uint8_t>());
+	device_command poll_command(device_command_code::poll);
 
-	std::vector<std::uint8_t> response = this->get_command_result(poll_command);
+	frame response;
+	this->get_command_result(poll_command, response);
 
 	if (response.size() == poll_min_result_data_size) {
 		return device_state((device_state_code)response[0], 0);
@@ -312,33 +752,38 @@ bill_validator::device_state bill_validator::poll() {
 		return device_state((device_state_code)response[0], (device_state_info)response[1]);
 	}
 
-	throw std::exception("invalid data received");
+	throw std::runtime_error("invalid data received");
 }
 
 void bill_validator::stack_bill() {
-	device_command stack_bill_command(device_command_code::stack_bill, std::vector<std::uint8_t>());
+	device_command stack_bill_command(device_command_code::stack_bill);
+
+	this->record_journal_event(journal_event::stack_requested, device_state(this->current_device_state.code, this->escrow_bill_type_number));
 
 	this->send_command(stack_bill_command);
 }
 
 void bill_validator::return_bill() {
-	device_command return_bill_command(device_command_code::return_bill, std::vector<std::uint8_t>());
+	device_command return_bill_command(device_command_code::return_bill);
+
+	this->record_journal_event(journal_event::return_requested, device_state(this->current_device_state.code, this->escrow_bill_type_number));
 
 	this->send_command(return_bill_command);
 }
 
 device_info bill_validator::request_device_info() {
-	const device_command get_device_info_command(device_command_code::identification, std::vector<std::uint8_t>());
+	const device_command get_device_info_command(device_command_code::identification);
 
-	const std::vector<std::uint8_t> response = this->get_command_result(get_device_info_command);
+	frame response;
+	this->get_command_result(get_device_info_command, response);
 
 	if (response.size() != identification_result_data_size) {
-		throw std::exception("invalid data received");
+		throw std::runtime_error("invalid data received");
 	}
 
 	const std::string part_number = trim(std::string(response.cbegin(), response.cbegin() + 15));
 	const std::string serial_number = trim(std::string(response.cbegin() + 15, response.cbegin() + 15 + 12));
-	std::vector<std::uint8_t> asset_number_bytes(8);
+	frame asset_number_bytes(8);
 	std::copy(response.cbegin() + 15 + 12, response.cend(), asset_number_bytes.begin() + 1);
 	const std::uint64_t asset_number = this->read_uint64(asset_number_bytes);
 
@@ -346,179 +791,443 @@ device_info bill_validator::request_device_info() {
 }
 
 void bill_validator::hold_bill() {
-	device_command hold_bill_command(device_command_code::hold_bill, std::vector<std::uint8_t>());
+	device_command hold_bill_command(device_command_code::hold_bill);
 
 	this->send_command(hold_bill_command);
 }
 
+void bill_validator::request_escrow_decision() {
+	this->escrow_decision = this->connected_device_operator->request_cash_action(this->bill_types_index->get_cash_type(this->escrow_bill_type_number));
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	this->escrow_decision_deadline = now + this->device_escrow_policy.decision_timeout;
+	// the bill is held right away unless the decision arrives by the next step
+	this->next_hold_time = now;
+}
+
+void bill_validator::process_escrow_decision() {
+	if ((this->current_device_state.code != device_state_code::escrow_pos) && (this->current_device_state.code != device_state_code::holding)) {
+		// the bill has left the escrow position without the decision
+		this->escrow_decision = std::future<cash_action>();
+		return;
+	}
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	cash_action action = this->device_escrow_policy.default_action;
+
+	if (this->escrow_decision.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		try {
+			action = this->escrow_decision.get();
+		} catch (std::exception) {
+			// the operator has failed to decide
+		}
+	} else if (now >= this->escrow_decision_deadline) {
+		this->escrow_decision = std::future<cash_action>();
+	} else {
+		if (now >= this->next_hold_time) {
+			this->hold_bill();
+			this->next_hold_time = now + this->device_escrow_policy.hold_interval;
+		}
+		return;
+	}
+
+	switch (action) {
+		case cash_action::accept_cash: {
+			this->stack_bill();
+			break;
+		}
+		case cash_action::hold_cash: {
+			// keep the bill and ask the operator again
+			this->hold_bill();
+			this->request_escrow_decision();
+			this->next_hold_time = std::chrono::steady_clock::now() + this->device_escrow_policy.hold_interval;
+			break;
+		}
+		case cash_action::return_cash: {
+			this->return_bill();
+			break;
+		}
+	}
+}
+
 std::map<std::uint8_t, cash_type> bill_validator::request_bill_table() {
-	const device_command get_bill_table_command(device_command_code::get_bill_table, std::vector<std::uint8_t>());
+	const device_command get_bill_table_command(device_command_code::get_bill_table);
+
+	frame response;
+	this->get_command_result(get_bill_table_command, response);
+
+	return decode_bill_table(response);
+}
 
-	const std::vector<std::uint8_t> response = this->get_command_result(get_bill_table_command);
+std::map<std::uint8_t, cash_type> bill_validator::request_cached_bill_table() {
+	this->bill_table_revalidation_required = false;
 
-	if (response.size() != get_bill_table_result_data_size) {
-		throw std::exception("invalid data received");
+	if (this->cache == nullptr) {
+		return this->request_bill_table();
 	}
 
-	std::map<std::uint8_t, cash_type> bill_types_by_numbers;
+	try {
+		this->firmware_crc32 = this->request_firmware_crc32();
+	} catch (std::exception) {
+		// the device does not report the CRC32 of its firmware, its bill table is not cached
+		return this->request_bill_table();
+	}
 
-	for (std::uint8_t bill_type_number = 0; bill_type_number < bill_types_count_max; ++bill_type_number) {
-		const std::size_t offset = bill_type_number * bill_type_record_size;
+	std::map<std::uint8_t, cash_type> bill_table;
+	if (this->cache->find_bill_table(this->connected_device_info.serial_number, this->firmware_crc32, bill_table)) {
+		// the table may have been changed without the firmware
+		this->bill_table_revalidation_required = true;
+		return bill_table;
+	}
 
-		if (response[offset] == 0) {
-			continue;
+	bill_table = this->request_bill_table();
+	this->store_cached_bill_table(bill_table);
+	return bill_table;
+}
+
+void bill_validator::revalidate_bill_table() {
+	// the device rejecting the command is not asked again
+	this->bill_table_revalidation_required = false;
+
+	try {
+		const std::map<std::uint8_t, cash_type> bill_table = this->request_bill_table();
+
+		if (bill_table != this->bill_types_index->get_bill_types_by_numbers()) {
+			this->replace_bill_table(bill_table);
+			this->publish_snapshot(true);
+			this->store_cached_bill_table(bill_table);
 		}
+	} catch (std::exception) {
+		// the cached table is kept,
+		// a lost connection is detected by the next poll
+	}
+}
 
-		std::string country_code;
-		country_code += (char)(response[offset + 1]);
-		country_code += (char)(response[offset + 2]);
-		country_code += (char)(response[offset + 3]);
+void bill_validator::store_cached_bill_table(const std::map<std::uint8_t, cash_type>& bill_table) {
+	try {
+		this->cache->store_bill_table(this->connected_device_info.serial_number, this->firmware_crc32, bill_table);
+	} catch (std::exception) {
+		// the table is read from the device on the next initialization
+	}
+}
 
-		// TODO: country to currency mapping required
-		const std::string currency_code = country_code;
+void bill_validator::request_status(std::chrono::steady_clock::time_point push_time, frame& status) {
+	const std::chrono::milliseconds ttl(this->status_cache_ttl.load(std::memory_order_relaxed));
 
-		const std::uint64_t minor_currency_units_per_major = 100; // currency: RUB
-		std::uint64_t denomination = 0;
-		if (is_bit_set(response[offset + 4], exponent_sign_bit_number)) {
-			denomination = response[offset] * minor_currency_units_per_major;
+	// the status received after the command has been pushed answers it as well,
+	// so the status requests waiting together share a single exchange
+	if ((!this->is_status_cached) || ((push_time > this->status_time) && (std::chrono::steady_clock::now() - this->status_time >= ttl))) {
+		const device_command get_status_command(device_command_code::get_status);
 
-			if (denomination % (power(currency_base, get_abs_exponent(response[offset + 4]))) != 0) {
-				throw std::exception("invalid cash type");
-			}
+		frame response;
+		this->get_command_result(get_status_command, response);
 
-			denomination /= (power(currency_base, get_abs_exponent(response[offset + 4])));
-		} else {
-			denomination = response[offset] * minor_currency_units_per_major;
-			denomination *= (power(currency_base, get_abs_exponent(response[offset + 4])));
+		if (response.size() != status_result_data_size) {
+			throw std::runtime_error("invalid data received");
 		}
 
-		bill_types_by_numbers[bill_type_number] = cash_type(currency_code, denomination);
+		std::copy(response.cbegin(), response.cend(), this->cached_status.begin());
+		this->status_time = std::chrono::steady_clock::now();
+		this->is_status_cached = true;
 	}
 
-	return bill_types_by_numbers;
+	status.clear();
+	status.append(this->cached_status.data(), this->cached_status.size());
 }
 
-void bill_validator::get_bill_types_handler(const std::vector<std::uint8_t>& data, void* untyped_result) {
+void bill_validator::invalidate_status() {
+	this->is_status_cached = false;
+}
+
+void bill_validator::get_bill_types_handler(const frame& data, request* untyped_result) {
 	std::set<cash_type> bill_types;
 
-	std::transform(this->bill_types_by_numbers.begin(), this->bill_types_by_numbers.end(), std::inserter(bill_types, bill_types.end()),
-		[](std::pair<std::uint8_t, cash_type> p) { return p.second; });
+	std::transform(this->bill_types_index->get_bill_types_by_numbers().cbegin(), this->bill_types_index->get_bill_types_by_numbers().cend(), std::inserter(bill_types, bill_types.end()),
+		[](const std::pair<const std::uint8_t, cash_type>& p) { return p.second; });
 
-	std::promise<std::set<cash_type>>* result = reinterpret_cast<std::promise<std::set<cash_type>>*>(untyped_result);
+	typed_request<std::set<cash_type>>* result = static_cast<typed_request<std::set<cash_type>>*>(untyped_result);
 	result->set_value(bill_types);
-	delete result;
+	this->release_request(result);
 }
 
-void bill_validator::get_device_info_handler(const std::vector<std::uint8_t>& data, void* untyped_result) {
-	std::promise<device_info>* result = reinterpret_cast<std::promise<device_info>*>(untyped_result);
+void bill_validator::get_device_info_handler(const frame& data, request* untyped_result) {
+	typed_request<device_info>* result = static_cast<typed_request<device_info>*>(untyped_result);
 	result->set_value(this->connected_device_info);
-	delete result;
+	this->release_request(result);
 }
 
-void bill_validator::get_enabled_bill_types_handler(const std::vector<std::uint8_t>& data, void* untyped_result) {
-	std::promise<std::set<cash_type>>* result = reinterpret_cast<std::promise<std::set<cash_type>>*>(untyped_result);
+void bill_validator::get_enabled_bill_types_handler(std::chrono::steady_clock::time_point push_time, request* untyped_result) {
+	typed_request<std::set<cash_type>>* result = static_cast<typed_request<std::set<cash_type>>*>(untyped_result);
 
 	try {
-		device_command get_enabled_bill_types_command(device_command_code::get_status, data);
+		frame status;
+		this->request_status(push_time, status);
 
-		std::vector<std::uint8_t> response = this->get_command_result(get_enabled_bill_types_command);
+		result->set_value(decode_enabled_bill_types(status, *this->bill_types_index));
+		this->release_request(result);
+	} catch (std::exception) {
+		result->fail(std::make_exception_ptr(std::runtime_error("command processing error")));
+		this->release_request(result);
+		throw;
+	}
+}
 
-		if (response.size() != get_status_result_data_size) {
-			throw std::exception("invalid data received");
-		}
+void bill_validator::set_enabled_bill_types_handler(const frame& data, request* untyped_result) {
+	typed_request<void>* result = static_cast<typed_request<void>*>(untyped_result);
 
-		// process the first 3 bytes of the response related to the enabled bill types info
-		std::set<cash_type> enabled_bill_types;
-		std::uint8_t bill_type_number = 0;
+	try {
+		device_command set_enabled_bill_types_command(device_command_code::enable_bill_types, data.data(), data.size());
 
-		for (std::vector<std::uint8_t>::const_reverse_iterator iter = response.crbegin() + 3; iter != response.crend(); ++iter) {
-			for (std::size_t bit_number = 0; bit_number < byte_size; ++bit_number) {
-				if (is_bit_set(*iter, bill_type_number % byte_size)) {
-					if (this->bill_types_by_numbers.count(bill_type_number) > 0) {
-						enabled_bill_types.insert(this->bill_types_by_numbers.at(bill_type_number));
-					}
-				}
-				++bill_type_number;
-			}
-		}
+		this->invalidate_status();
+		this->send_command(set_enabled_bill_types_command);
 
-		result->set_value(enabled_bill_types);
-		delete result;
+		std::copy(data.cbegin(), data.cend(), this->desired_enabled_bill_types.begin());
+		this->has_desired_enabled_bill_types = true;
+
+		result->set_value();
+		this->release_request(result);
 	} catch (std::exception) {
-		result->set_exception(std::make_exception_ptr(std::exception("command processing error")));
-		delete result;
+		result->fail(std::make_exception_ptr(std::runtime_error("command processing error")));
+		this->release_request(result);
 		throw;
 	}
 }
 
-void bill_validator::set_enabled_bill_types_handler(const std::vector<std::uint8_t>& data, void* untyped_result) {
-	std::promise<void>* result = reinterpret_cast<std::promise<void>*>(untyped_result);
+void bill_validator::get_bill_types_security_levels_handler(std::chrono::steady_clock::time_point push_time, request* untyped_result) {
+	typed_request<std::map<cash_type, bill_security_level>>* result = static_cast<typed_request<std::map<cash_type, bill_security_level>>*>(untyped_result);
 
 	try {
-		device_command set_enabled_bill_types_command(device_command_code::enable_bill_types, data);
+		frame status;
+		this->request_status(push_time, status);
 
-		this->send_command(set_enabled_bill_types_command);
+		result->set_value(decode_bill_types_security_levels(status, *this->bill_types_index));
+		this->release_request(result);
+	} catch (std::exception) {
+		result->fail(std::make_exception_ptr(std::runtime_error("command processing error")));
+		this->release_request(result);
+		throw;
+	}
+}
+
+void bill_validator::set_bill_types_security_levels_handler(const frame& data, request* untyped_result) {
+	typed_request<void>* result = static_cast<typed_request<void>*>(untyped_result);
+
+	try {
+		device_command set_bill_types_security_levels_command(device_command_code::set_security, data.data(), data.size());
+
+		this->invalidate_status();
+		this->send_command(set_bill_types_security_levels_command);
+
+		std::copy(data.cbegin(), data.cend(), this->desired_security_levels.begin());
+		this->has_desired_security_levels = true;
 
 		result->set_value();
-		delete result;
+		this->release_request(result);
 	} catch (std::exception) {
-		result->set_exception(std::make_exception_ptr(std::exception("command processing error")));
-		delete result;
+		result->fail(std::make_exception_ptr(std::runtime_error("command processing error")));
+		this->release_request(result);
 		throw;
 	}
 }
 
-void bill_validator::get_bill_types_security_levels_handler(const std::vector<std::uint8_t>& data, void* untyped_result) {
-	std::promise<std::map<cash_type, bill_security_level>>* result = reinterpret_cast<std::promise<std::map<cash_type, bill_security_level>>*>(untyped_result);
+void bill_validator::update_firmware_handler(std::shared_ptr<const firmware_image> image, request* untyped_result) {
+	typed_request<firmware_update_result>* result = static_cast<typed_request<firmware_update_result>*>(untyped_result);
+
+	if (image->size() > ((std::size_t)1 << (8 * download_address_size))) {
+		result->fail(std::make_exception_ptr(std::runtime_error("firmware image is too large")));
+		this->release_request(result);
+		return;
+	}
+
+	if (!this->download_mode_entered) {
+		// DOWNLOAD and GET CRC32 are illegal while the device accepts bills
+		if (this->initialization_required || (!is_service_state(this->current_device_state.code))) {
+			result->fail(std::make_exception_ptr(std::runtime_error("firmware can not be downloaded in the current state")));
+			this->release_request(result);
+			return;
+		}
+
+		try {
+			if (this->request_firmware_crc32() == image->get_crc32()) {
+				result->set_value(firmware_update_result::up_to_date);
+				this->release_request(result);
+				return;
+			}
+		} catch (std::exception) {
+			result->fail(std::make_exception_ptr(std::runtime_error("command processing error")));
+			this->release_request(result);
+			throw;
+		}
+	}
 
 	try {
-		device_command get_bill_types_security_levels_command(device_command_code::get_status, data);
+		this->enter_download_mode();
+	} catch (std::exception& error) {
+		result->fail(std::make_exception_ptr(std::runtime_error(error.what())));
+		this->release_request(result);
+
+		if (!this->download_mode_entered) {
+			// nothing has been written, the device is reinitialized as after any lost command
+			throw;
+		}
+		return;
+	}
+
+	// the handler continues the download instead of polling,
+	// the commands queued meanwhile are failed until the download is over
+	this->downloaded_image = std::move(image);
+	this->downloaded_size = 0;
+	this->firmware_result = result;
+}
+
+void bill_validator::enter_download_mode() {
+	if (!this->download_mode_entered) {
+		const device_command download_command(device_command_code::download);
+		this->send_command(download_command, download_mode_timeout);
+
+		this->download_mode_entered = true;
+		this->escrow_decision = std::future<cash_action>();
+		this->publish_snapshot(false);
+	}
+
+	// the status completes the transition, the boot loader reports the previous operation after a failed download
+	const std::uint8_t status = this->send_download_subcommand(download_request_status);
+	if ((status != download_ready) && (status != download_succeeded) && (status != download_failed)) {
+		throw std::runtime_error("invalid data received");
+	}
+
+	const std::uint8_t block_size_index = this->send_download_subcommand(download_request_block_size);
+	if (block_size_index > download_block_size_index_max) {
+		throw std::runtime_error("invalid data received");
+	}
+
+	this->download_block_size = (std::size_t)1 << block_size_index;
+}
 
-		std::vector<std::uint8_t> response = this->get_command_result(get_bill_types_security_levels_command);
+std::uint8_t bill_validator::send_download_subcommand(std::uint8_t subcommand) {
+	const device_command download_command(device_command_code::download, &subcommand, 1);
 
-		if (response.size() != get_status_result_data_size) {
-			throw std::exception("invalid data received");
+	frame response;
+	this->get_command_result(download_command, response);
+
+	if (response.size() != 1) {
+		throw std::runtime_error("invalid data received");
+	}
+
+	return response[0];
+}
+
+void bill_validator::download_firmware_block() {
+	typed_request<firmware_update_result>* result = static_cast<typed_request<firmware_update_result>*>(this->firmware_result);
+
+	try {
+		// the last block is padded to the block size with the erased flash value
+		const std::size_t image_part_size = std::min(this->downloaded_image->size() - this->downloaded_size, this->download_block_size);
+		std::vector<std::uint8_t> block_data(download_address_size + this->download_block_size, 0xff);
+		store_uint(block_data.data(), this->downloaded_size, download_address_size);
+		std::copy_n(this->downloaded_image->data() + this->downloaded_size, image_part_size, block_data.begin() + download_address_size);
+
+		const std::uint8_t prefix[] = { (std::uint8_t)device_command_code::download, download_write };
+		extended_frame command_frame;
+		encode_extended_frame(command_frame, this->device_address, prefix, sizeof(prefix), block_data.data(), block_data.size());
+
+		frame response;
+		this->get_command_result(device_command_code::download, command_frame, response);
+
+		if ((response.size() != 1) || (response[0] != download_succeeded)
+			|| (this->send_download_subcommand(download_request_status) != download_succeeded)) {
+			throw std::runtime_error("firmware block is not written");
 		}
 
-		// process the second 3 bytes of the response related to the bill types security levels info
-		std::map<cash_type, bill_security_level> bill_types_security_levels;
-		std::uint8_t bill_type_number = 0;
+		this->downloaded_size += image_part_size;
+		this->downloaded_image->report_progress(this->downloaded_size);
 
-		for (std::vector<std::uint8_t>::const_reverse_iterator iter = response.crbegin(); iter != response.crbegin() + 3; ++iter) {
-			for (std::size_t bit_number = 0; bit_number < byte_size; ++bit_number) {
-				if (is_bit_set(*iter, bill_type_number % byte_size)) {
-					bill_types_security_levels[this->bill_types_by_numbers.at(bill_type_number)] = bill_security_level::high;
-				} else {
-					bill_types_security_levels[this->bill_types_by_numbers.at(bill_type_number)] = bill_security_level::normal;
-				}
-				++bill_type_number;
-			}
+		if (this->downloaded_size < this->downloaded_image->size()) {
+			return;
 		}
 
-		result->set_value(bill_types_security_levels);
-		delete result;
-	} catch (std::exception) {
-		result->set_exception(std::make_exception_ptr(std::exception("command processing error")));
-		delete result;
-		throw;
+		// the boot loader checks the CRC of the written firmware and starts it
+		const std::uint8_t status = this->send_download_subcommand(download_exit);
+		if (status == download_crc_mismatch) {
+			throw std::runtime_error("firmware verification failed");
+		} else if (status != download_succeeded) {
+			throw std::runtime_error("invalid data received");
+		}
+
+		result->set_value(firmware_update_result::updated);
+	} catch (std::exception& error) {
+		// the partially written device stays in the boot loader
+		// instead of being reset, until the download is retried
+		result->fail(std::make_exception_ptr(std::runtime_error(error.what())));
+		this->release_request(result);
+		this->downloaded_image.reset();
+		this->firmware_result = nullptr;
+		return;
 	}
+
+	this->release_request(result);
+	this->downloaded_image.reset();
+	this->firmware_result = nullptr;
+	this->download_mode_entered = false;
+	// the device starts the new firmware
+	this->initialization_required = true;
 }
 
-void bill_validator::set_bill_types_security_levels_handler(const std::vector<std::uint8_t>& data, void* untyped_result) {
-	std::promise<void>* result = reinterpret_cast<std::promise<void>*>(untyped_result);
+std::uint32_t bill_validator::request_firmware_crc32() {
+	const device_command get_crc32_command(device_command_code::get_crc32);
 
-	try {
-		device_command set_bill_types_security_levels_command(device_command_code::set_security, data);
+	frame response;
+	this->get_command_result(get_crc32_command, response);
 
-		this->send_command(set_bill_types_security_levels_command);
+	if (response.size() != get_crc32_result_data_size) {
+		throw std::runtime_error("invalid data received");
+	}
 
-		result->set_value();
-		delete result;
+	return ((std::uint32_t)response[0] << 24) | ((std::uint32_t)response[1] << 16) | ((std::uint32_t)response[2] << 8) | response[3];
+}
+
+bool bill_validator::is_service_slot() const {
+	return is_service_state(this->current_device_state.code)
+		&& (!this->escrow_decision.valid())
+		&& (!this->has_pending_commands());
+}
+
+bool bill_validator::is_statistics_due(std::chrono::steady_clock::time_point poll_time) const {
+	// the response keeps the line busy for seconds, the other devices on it may not be handling bills meanwhile
+	return this->statistics_supported && (this->device_poll_policy.statistics_interval.count() != 0)
+		&& (poll_time >= this->next_statistics_time) && this->is_service_slot() && this->device_bus->is_idle_except(this);
+}
+
+void bill_validator::collect_statistics() {
+	const device_command request_statistics_command(device_command_code::request_statistics);
+	this->next_statistics_time = std::chrono::steady_clock::now() + this->device_poll_policy.statistics_interval;
+
+	frame command_frame;
+	this->build_command_frame(request_statistics_command, command_frame);
+
+	// the response is sent in an extended frame
+	extended_frame response;
+	try {
+		this->get_command_result(request_statistics_command.code, command_frame, response);
 	} catch (std::exception) {
-		result->set_exception(std::make_exception_ptr(std::exception("command processing error")));
-		delete result;
-		throw;
+		// the devices not supporting the command are not reinitialized for it
+		// and are not asked again, a lost connection is detected by the next poll
+		if ((response.size() == 1) && (response[0] == ill_cmd)) {
+			this->statistics_supported = false;
+		}
+		return;
+	}
+
+	std::shared_ptr<const statistics_report> report;
+	try {
+		report = std::make_shared<statistics_report>(decode_statistics_report(response));
+	} catch (std::exception) {
+		// the device keeps working with damaged statistics,
+		// the previous ones are kept until it sends valid ones
+		return;
 	}
+
+	std::atomic_store(&this->collected_report, report);
 }
 
 std::uint16_t bill_validator::read_uint16(const frame& frame) const {
@@ -528,218 +1237,164 @@ std::uint16_t bill_validator::read_uint16(const frame& frame) const {
 std::uint64_t bill_validator::read_uint64(const frame& frame) const {
 	assert(frame.size() >= sizeof(std::uint64_t));
 
-	std::vector<std::uint8_t> bytes(sizeof(std::uint64_t));
+	std::array<std::uint8_t, sizeof(std::uint64_t)> bytes;
 	// assume little-endian byte order architecture
 	std::copy(frame.crbegin(), frame.crbegin() + 8, bytes.begin());
 	return *reinterpret_cast<const std::uint64_t*>(bytes.data());
 }
 
-void bill_validator::write_uint16(frame& frame, std::uint16_t value) const {
-	frame.push_back((std::uint8_t)(value & 0xFF));
-	frame.push_back((std::uint8_t)(value >> 8));
+void bill_validator::build_command_frame(const device_command& command, frame& command_frame) const {
+	encode_frame(command_frame, this->device_address, (std::uint8_t)command.code, command.data, command.data_size);
 }
 
-bill_validator::frame bill_validator::build_command_frame(const device_command& command) const {
-	frame command_frame(command.data);
-	// 0 is a reserved byte for the frame length
-	command_frame.insert(command_frame.begin(), { sync, bill_validator_addr, 0, (std::uint8_t)command.code });
-	// set the frame length considering the frame check sequence size
-	command_frame[2] = command_frame.size() + sizeof(crc16);
-	// add the frame check sequence
-	this->write_uint16(command_frame, get_crc(command_frame));
+void bill_validator::get_command_result(const device_command& command, frame& payload) {
+	frame command_frame;
+	this->build_command_frame(command, command_frame);
 
-	return command_frame;
+	this->get_command_result(command.code, command_frame, payload);
 }
 
-std::vector<std::uint8_t> bill_validator::get_command_result(const device_command& command) {
-	const frame command_frame = this->build_command_frame(command);
-
+template<typename CommandFrame, typename Payload>
+void bill_validator::get_command_result(device_command_code code, const CommandFrame& command_frame, Payload& payload) {
+	this->device_statistics_recorder->increment(statistics_recorder::counter::commands);
+	std::chrono::steady_clock::time_point start_time;
 	bool response_received = false;
-	std::vector<std::uint8_t> header(header_size);
-	std::vector<std::uint8_t> payload;
-	std::vector<std::uint8_t> crc(sizeof(crc16));
+	std::uint8_t response_address = 0;
 
 	try {
 		for (int try_count = 3; (!response_received) && (try_count > 0); --try_count) {
 			// try to receive not nak response
-			write(this->serial_port, buffer(command_frame));
-			// TODO: async variant (timeout handling)
-			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			this->device_bus->write_frame(command_frame);
+
+			if (try_count == 3) {
+				// the latency covers the retries but not the line silence preceding the command
+				start_time = std::chrono::steady_clock::now();
+			} else {
+				this->device_statistics_recorder->increment(statistics_recorder::counter::retries);
+			}
 
 			bool frame_received = false;
-			for (int try_count = 5; (!frame_received) && (try_count > 0); --try_count) {
+			bool response_timed_out = false;
+			for (int try_count = 5; (!frame_received) && (!response_timed_out) && (try_count > 0); --try_count) {
 				// try to receive the frame intended for the bill validator controller
-				read(this->serial_port, buffer(header, header_size));
-
-				if (header[sync_offset] != sync) {
-					throw std::exception("synchronisation error");
-				}
-
-				const std::size_t payload_size = header[lng_offset] - header_size - sizeof(crc16);
-				payload.resize(payload_size);
-				read(this->serial_port, buffer(payload, payload_size));
-				assert(payload.size() == payload_size);
-				read(this->serial_port, buffer(crc, sizeof(crc16)));
-
-				std::vector<std::uint8_t> response;
-				response.insert(response.end(), header.cbegin(), header.cend());
-				response.insert(response.end(), payload.cbegin(), payload.cend());
-
-				if (this->get_crc(response) != this->read_uint16(crc)) {
-					this->send_nak(header[adr_offset]);
-					std::this_thread::sleep_for(std::chrono::milliseconds(20));
-					throw std::exception("crc error");
-				}
-
-				if (header[adr_offset] == command_frame[adr_offset]) {
+				if (!this->device_bus->read_frame(response_address, payload, *this->device_statistics_recorder)) {
+					response_timed_out = true;
+				} else if (response_address == this->device_address) {
 					frame_received = true;
 				}
 			}
 
+			if (response_timed_out) {
+				// t-response time-out is the equivalent of a nak
+				this->device_statistics_recorder->increment(statistics_recorder::counter::timeouts);
+				continue;
+			}
+
 			if (!frame_received) {
-				throw std::exception("unable to receive data from bill validator");
+				throw std::runtime_error("unable to receive data from bill validator");
 			}
 
 			assert(payload.size() > 0);
 			if ((payload.size() == 1) && (payload[0] == ill_cmd)) {
 				// process illegal command packet
-				throw std::exception("illegal command");
+				this->device_statistics_recorder->increment(statistics_recorder::counter::illegal_commands);
+				throw std::runtime_error("illegal command");
 			} else if ((payload.size() == 1) && (payload[0] == nak)) {
 				// process nak packet
-				// nothing to do
+				this->device_statistics_recorder->increment(statistics_recorder::counter::naks);
 			} else {
 				// process data packet
-				this->send_ack(header[adr_offset]);
+				this->device_bus->send_ack(response_address);
 				response_received = true;
+				this->record_latency(code, start_time);
 			}
 		}
 	} catch (boost::system::system_error) {
-		throw std::exception("serial port read-write error");
+		throw std::runtime_error("serial port read-write error");
 	}
 
 	if (!response_received) {
 		// process nak response
-		throw std::exception("command was not correctly received by bill validator");
+		throw std::runtime_error("command was not correctly received by bill validator");
 	}
-
-	std::this_thread::sleep_for(std::chrono::milliseconds(20));
-
-	return payload;
 }
 
 void bill_validator::send_command(const device_command& command) {
-	const frame command_frame = this->build_command_frame(command);
+	this->send_command(command, this->device_bus->get_options().response_timeout);
+}
+
+void bill_validator::send_command(const device_command& command, std::chrono::milliseconds response_timeout) {
+	frame command_frame;
+	this->build_command_frame(command, command_frame);
 
+	this->device_statistics_recorder->increment(statistics_recorder::counter::commands);
+	std::chrono::steady_clock::time_point start_time;
 	bool response_received = false;
-	std::vector<std::uint8_t> header(header_size);
-	std::vector<std::uint8_t> payload;
-	std::vector<std::uint8_t> crc(sizeof(crc16));
+	std::uint8_t response_address = 0;
+	frame payload;
 
 	try {
 		for (int try_count = 3; (!response_received) && (try_count > 0); --try_count) {
 			// try to receive not nak response
-			write(this->serial_port, buffer(command_frame));
-			// TODO: async variant (timeout handling)
-			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			this->device_bus->write_frame(command_frame);
+
+			if (try_count == 3) {
+				// the latency covers the retries but not the line silence preceding the command
+				start_time = std::chrono::steady_clock::now();
+			} else {
+				this->device_statistics_recorder->increment(statistics_recorder::counter::retries);
+			}
 
 			bool frame_received = false;
-			for (int try_count = 5; (!frame_received) && (try_count > 0); --try_count) {
+			bool response_timed_out = false;
+			for (int try_count = 5; (!frame_received) && (!response_timed_out) && (try_count > 0); --try_count) {
 				// try to receive the frame intended for the bill validator controller
-				read(this->serial_port, buffer(header, header_size));
-
-				if (header[sync_offset] != sync) {
-					throw std::exception("synchronisation error");
-				}
-
-				const std::size_t payload_size = header[lng_offset] - header_size - sizeof(crc16);
-				payload.resize(payload_size);
-				read(this->serial_port, buffer(payload, payload_size));
-				assert(payload.size() == payload_size);
-				read(this->serial_port, buffer(crc, sizeof(crc16)));
-
-				std::vector<std::uint8_t> response;
-				response.insert(response.end(), header.cbegin(), header.cend());
-				response.insert(response.end(), payload.cbegin(), payload.cend());
-
-				if (this->get_crc(response) != this->read_uint16(crc)) {
-					this->send_nak(header[adr_offset]);
-					std::this_thread::sleep_for(std::chrono::milliseconds(20));
-					throw std::exception("crc error");
-				}
-
-				if (header[adr_offset] == command_frame[adr_offset]) {
+				if (!this->device_bus->read_frame(response_address, payload, response_timeout, *this->device_statistics_recorder)) {
+					response_timed_out = true;
+				} else if (response_address == this->device_address) {
 					frame_received = true;
 				}
 			}
 
+			if (response_timed_out) {
+				// t-response time-out is the equivalent of a nak
+				this->device_statistics_recorder->increment(statistics_recorder::counter::timeouts);
+				continue;
+			}
+
 			if (!frame_received) {
-				throw std::exception("unable to receive data from bill validator");
+				throw std::runtime_error("unable to receive data from bill validator");
 			}
 
 			// only control packet is expected
 			assert(payload.size() == 1);
 			// process control packet
 			if (payload[0] == ill_cmd) {
-				throw std::exception("illegal command");
+				this->device_statistics_recorder->increment(statistics_recorder::counter::illegal_commands);
+				throw std::runtime_error("illegal command");
 			}
 
 			if (payload[0] == ack) {
+				this->device_statistics_recorder->increment(statistics_recorder::counter::acks);
 				response_received = true;
-			} else if (payload[0] != nak) {
-					throw std::exception("invalid payload");
+				this->record_latency(command.code, start_time);
+			} else if (payload[0] == nak) {
+				this->device_statistics_recorder->increment(statistics_recorder::counter::naks);
+			} else {
+					throw std::runtime_error("invalid payload");
 			}
 		}
 	} catch (boost::system::system_error) {
-		throw std::exception("serial port read-write error");
+		throw std::runtime_error("serial port read-write error");
 	}
 
 	if (!response_received) {
 		// process nak response
-		throw std::exception("command was not correctly received by bill validator");
-	}
-
-	std::this_thread::sleep_for(std::chrono::milliseconds(20));
-}
-
-bill_validator::crc16 bill_validator::get_crc(const frame& frame) const {
-	std::uint16_t crc = 0;
-
-	for (std::size_t i = 0; i < frame.size(); i++) {
-		crc ^= frame[i];
-
-		for (std::uint8_t j = 0; j < 8; j++) {
-			if (crc & 0x0001) {
-				crc >>= 1;
-				crc ^= POLYNOMIAL;
-			} else {
-				crc >>= 1;
-			}
-		}
+		throw std::runtime_error("command was not correctly received by bill validator");
 	}
-
-	return crc;
 }
 
-void bill_validator::send_ack(std::uint8_t device_address) {
-	frame ack_frame;
-	// 0 is a reserved byte for the frame length
-	ack_frame.insert(ack_frame.begin(), { sync, device_address, 0, ack });
-	// set the frame length considering the frame check sequence size
-	ack_frame[2] = ack_frame.size() + sizeof(crc16);
-	// add the frame check sequence
-	this->write_uint16(ack_frame, this->get_crc(ack_frame));
-
-	write(this->serial_port, buffer(ack_frame));
-}
-
-void bill_validator::send_nak(std::uint8_t device_address) {
-	frame nak_frame;
-	// 0 is a reserved byte for the frame length
-	nak_frame.insert(nak_frame.begin(), { sync, device_address, 0, nak });
-	// set the frame length considering the frame check sequence size
-	nak_frame[2] = nak_frame.size() + sizeof(crc16);
-	// add the frame check sequence
-	this->write_uint16(nak_frame, this->get_crc(nak_frame));
-
-	write(this->serial_port, buffer(nak_frame));
+void bill_validator::record_latency(device_command_code code, std::chrono::steady_clock::time_point start_time) {
+	this->device_statistics_recorder->record_latency((std::uint8_t)code,
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time));
 }
@@ -0,0 +1,313 @@
+#include "bus.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include "asio_serial_transport.h"
+#include "bill_validator.h"
+#ifdef __linux__
+#include "linux_serial_transport.h"
+#endif
+#include "protocol.h"
+#include "statistics_recorder.h"
+
+using namespace boost::asio;
+using namespace ccnet;
+
+// start bit, data bits, parity bit and stop bits
+std::uint8_t get_bits_per_transferred_byte(const connection_options& options) {
+	return 1 + options.character_size
+		+ ((options.parity == connection_options::parity_type::none) ? 0 : 1)
+		+ ((options.stop_bits == connection_options::stop_bits_type::one) ? 1 : 2);
+}
+
+// opens the line with the transport backend of the options
+std::unique_ptr<serial_transport> open_transport(boost::asio::io_service& io_service, const std::string& port_name, const connection_options& options) {
+	if (options.custom_transport) {
+		return options.custom_transport(port_name, options);
+	}
+
+	switch (options.transport) {
+		case connection_options::transport_type::asio: {
+			return std::unique_ptr<serial_transport>(new asio_serial_transport(io_service, port_name));
+		}
+#ifdef __linux__
+		case connection_options::transport_type::linux_low_latency: {
+			return std::unique_ptr<serial_transport>(new linux_serial_transport(port_name));
+		}
+#endif
+		default: {
+			throw std::runtime_error("transport is not supported");
+		}
+	}
+}
+
+bus::bus(boost::asio::io_service& io_service, const std::string& port_name, const connection_options& options) :
+	options(options),
+	baud_rate(options.baud_rate),
+	baud_rate_locked(options.probe_baud_rates.empty()),
+	transport(open_transport(io_service, port_name, options)),
+	parser(),
+	line_free_time(),
+	devices(),
+	next_device_index(0) {
+	if ((options.baud_rate == 0) || (options.character_size < 5) || (options.character_size > 8)) {
+		throw std::runtime_error("invalid connection options");
+	}
+
+	this->transport->set_options(options);
+}
+
+void bus::attach(bill_validator* device) {
+	for (std::vector<device_entry>::const_iterator iter = this->devices.cbegin(); iter != this->devices.cend(); ++iter) {
+		if (iter->device->device_address == device->device_address) {
+			throw std::runtime_error("device address is already in use");
+		}
+	}
+
+	// the device may be stepped by a worker as soon as the scheduler lock is released
+	device->device_bus = this;
+	this->devices.push_back(device_entry(device));
+}
+
+void bus::detach(bill_validator* device) {
+	this->devices.erase(std::remove_if(this->devices.begin(), this->devices.end(),
+		[device](const device_entry& entry) { return entry.device == device; }), this->devices.end());
+	this->next_device_index = 0;
+}
+
+bool bus::is_empty() const {
+	return this->devices.empty();
+}
+
+bool bus::is_idle_except(const bill_validator* device) const {
+	for (std::vector<device_entry>::const_iterator iter = this->devices.cbegin(); iter != this->devices.cend(); ++iter) {
+		if ((iter->device != device) && (!iter->device->is_service_slot())) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const connection_options& bus::get_options() const {
+	return this->options;
+}
+
+void bus::set_baud_rate(std::uint32_t baud_rate) {
+	if (baud_rate == this->baud_rate) {
+		return;
+	}
+
+	this->transport->set_baud_rate(baud_rate);
+	this->baud_rate = baud_rate;
+	// the bytes received at the previous rate are garbage
+	this->parser.reset();
+	this->transport->discard_input();
+}
+
+std::uint32_t bus::get_baud_rate() const {
+	return this->baud_rate;
+}
+
+bool bus::is_baud_rate_locked() const {
+	return this->baud_rate_locked;
+}
+
+void bus::lock_baud_rate() {
+	this->baud_rate_locked = true;
+}
+
+void bus::run_once() {
+	const clock::time_point now = clock::now();
+
+	for (std::size_t i = 0; i < this->devices.size(); ++i) {
+		const std::size_t device_index = (this->next_device_index + i) % this->devices.size();
+		device_entry& entry = this->devices[device_index];
+
+		if (this->get_run_time(entry) <= now) {
+			entry.next_run_time = entry.device->step();
+			this->next_device_index = device_index + 1;
+			break;
+		}
+	}
+}
+
+bus::clock::time_point bus::get_next_run_time() const {
+	clock::time_point next_run_time = clock::time_point::max();
+
+	for (std::vector<device_entry>::const_iterator iter = this->devices.cbegin(); iter != this->devices.cend(); ++iter) {
+		next_run_time = std::min(next_run_time, this->get_run_time(*iter));
+	}
+
+	return next_run_time;
+}
+
+bus::clock::time_point bus::get_run_time(const device_entry& entry) const {
+	return entry.device->has_pending_commands() ? clock::time_point::min() : entry.next_run_time;
+}
+
+void bus::write_frame(const frame& command_frame) {
+	this->write_bytes(command_frame.data(), command_frame.size());
+}
+
+void bus::write_frame(const extended_frame& command_frame) {
+	this->write_bytes(command_frame.data(), command_frame.size());
+}
+
+bool bus::read_frame(std::uint8_t& device_address, frame& payload, statistics_recorder& recorder) {
+	return this->read_frame(device_address, payload, this->options.response_timeout, recorder);
+}
+
+bool bus::read_frame(std::uint8_t& device_address, frame& payload, std::chrono::milliseconds response_timeout, statistics_recorder& recorder) {
+	frame response;
+	const frame_parser::result receive_result = this->receive_frame(response, response_timeout, recorder);
+
+	if (receive_result == frame_parser::result::incomplete) {
+		return false;
+	}
+
+	if (receive_result == frame_parser::result::extended_frame_received) {
+		throw std::runtime_error("frame is too long");
+	}
+
+	device_address = response[adr_offset];
+	payload.clear();
+	payload.append(response.data() + header_size, response.size() - header_size - sizeof(std::uint16_t));
+
+	return true;
+}
+
+bool bus::read_frame(std::uint8_t& device_address, extended_frame& payload, statistics_recorder& recorder) {
+	frame response;
+	const frame_parser::result receive_result = this->receive_frame(response, this->options.response_timeout, recorder);
+
+	if (receive_result == frame_parser::result::incomplete) {
+		return false;
+	}
+
+	device_address = response[adr_offset];
+
+	if (receive_result == frame_parser::result::extended_frame_received) {
+		const extended_frame& extended_response = this->parser.get_extended_frame();
+		payload.assign(extended_response.cbegin() + header_size + extended_length_size, extended_response.cend() - sizeof(std::uint16_t));
+	} else {
+		payload.assign(response.cbegin() + header_size, response.cend() - sizeof(std::uint16_t));
+	}
+
+	return true;
+}
+
+void bus::write_bytes(const std::uint8_t* data, std::size_t size) {
+	// keep the line silent for t-free after the last confirmation
+	std::this_thread::sleep_until(this->line_free_time);
+	// the bytes received so far do not respond to this command
+	this->parser.reset();
+	this->transport->discard_input();
+
+	if (!this->transport->write(buffer(data, size), this->get_transmit_time(size))) {
+		throw std::runtime_error("serial port write timeout");
+	}
+}
+
+frame_parser::result bus::receive_frame(frame& response, std::chrono::milliseconds response_timeout, statistics_recorder& recorder) {
+	const clock::time_point start_time = clock::now();
+	const std::uint64_t sync_losses_count = this->parser.get_sync_losses_count();
+	// the time the response has been requested at, the start or the repetition
+	clock::time_point request_time = start_time;
+	// the response has to start within t-response
+	clock::time_point deadline = request_time + response_timeout + this->get_receive_time(header_size);
+	// the address of the last frame failing the frame check sequence
+	std::uint8_t corrupted_frame_address = 0;
+	bool corrupted_frame_received = false;
+	bool repeat_requested = false;
+	frame_parser::result parse_result = frame_parser::result::incomplete;
+
+	for (;;) {
+		parse_result = this->parser.parse(response);
+
+		if ((parse_result == frame_parser::result::frame_received) || (parse_result == frame_parser::result::extended_frame_received)) {
+			break;
+		}
+
+		if (parse_result == frame_parser::result::crc_error) {
+			// the frame may be line noise followed by the valid response,
+			// so the repetition is requested only if no valid frame follows
+			corrupted_frame_address = response[adr_offset];
+			corrupted_frame_received = true;
+			recorder.increment(statistics_recorder::counter::crc_errors);
+			continue;
+		}
+
+		const clock::time_point now = clock::now();
+		// the bytes of a frame follow each other within t-inter-byte
+		const clock::time_point read_deadline = this->parser.is_receiving()
+			? std::min(deadline, now + this->options.inter_byte_timeout + this->options.adapter_latency)
+			: deadline;
+		const std::size_t read_size = (now < read_deadline)
+			? this->transport->read_some(buffer(this->parser.get_write_position(), this->parser.get_write_size()), read_deadline - now)
+			: 0;
+
+		if ((read_size == 0) && this->parser.is_receiving()) {
+			// the frame has been broken off or its length is corrupted,
+			// the response may still start at a later sync byte
+			this->parser.resynchronise();
+			continue;
+		}
+
+		if (read_size == 0) {
+			if ((!corrupted_frame_received) || repeat_requested) {
+				recorder.increment(statistics_recorder::counter::sync_losses, this->parser.get_sync_losses_count() - sync_losses_count);
+				return frame_parser::result::incomplete;
+			}
+
+			// ask the device to repeat the response
+			this->send_nak(corrupted_frame_address);
+			repeat_requested = true;
+
+			request_time = clock::now();
+			deadline = request_time + response_timeout + this->get_receive_time(header_size);
+			continue;
+		}
+
+		this->parser.commit(read_size);
+		// wait for the rest of the frame being received,
+		// the line noise does not prolong the exchange beyond the longest frame
+		const std::size_t longest_frame_size = this->parser.is_receiving_extended_frame() ? extended_frame_size_max : frame::capacity;
+		const clock::time_point deadline_max = request_time + response_timeout + this->get_receive_time(longest_frame_size);
+		deadline = std::min(std::max(deadline, clock::now() + this->get_receive_time(this->parser.get_missing_size())), deadline_max);
+	}
+
+	const clock::time_point receive_time = clock::now();
+	this->line_free_time = receive_time + this->options.free_line_time;
+	recorder.record_exchange_latency(std::chrono::duration_cast<std::chrono::microseconds>(receive_time - start_time));
+	recorder.increment(statistics_recorder::counter::sync_losses, this->parser.get_sync_losses_count() - sync_losses_count);
+
+	return parse_result;
+}
+
+void bus::send_ack(std::uint8_t device_address) {
+	this->send_confirmation(device_address, ack);
+}
+
+void bus::send_nak(std::uint8_t device_address) {
+	this->send_confirmation(device_address, nak);
+}
+
+void bus::send_confirmation(std::uint8_t device_address, std::uint8_t confirmation) {
+	frame confirmation_frame;
+	encode_frame(confirmation_frame, device_address, confirmation, nullptr, 0);
+
+	if (!this->transport->write(buffer(confirmation_frame.data(), confirmation_frame.size()), this->get_transmit_time(confirmation_frame.size()))) {
+		throw std::runtime_error("serial port write timeout");
+	}
+
+	this->line_free_time = clock::now() + this->options.free_line_time;
+}
+
+std::chrono::microseconds bus::get_transmit_time(std::size_t bytes_count) const {
+	return std::chrono::microseconds(bytes_count * get_bits_per_transferred_byte(this->options) * 1000000 / this->baud_rate) + this->options.adapter_latency;
+}
+
+std::chrono::microseconds bus::get_receive_time(std::size_t bytes_count) const {
+	return this->get_transmit_time(bytes_count) + bytes_count * std::chrono::microseconds(this->options.inter_byte_timeout);
+}
@@ -0,0 +1,106 @@
+#ifndef CCNET_BUS_H
+#define CCNET_BUS_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include "connection_options.h"
+#include "frame.h"
+#include "frame_parser.h"
+#include "serial_transport.h"
+
+namespace ccnet {
+
+	class bill_validator;
+	class statistics_recorder;
+
+	// a serial line shared by the peripherals with different addresses;
+	// the devices are polled round-robin, one exchange on the line at a time
+	class bus {
+		public:
+			typedef std::chrono::steady_clock clock;
+
+			bus(boost::asio::io_service& io_service, const std::string& port_name, const connection_options& options);
+
+			bus(const bus& other) = delete;
+
+			bus& operator=(const bus& other) = delete;
+
+			void attach(bill_validator* device);
+			void detach(bill_validator* device);
+			bool is_empty() const;
+			// whether the other devices on the line are in their service slots,
+			// so a long exchange with the device delays nothing but their polls
+			bool is_idle_except(const bill_validator* device) const;
+
+			// the options the line has been opened with
+			const connection_options& get_options() const;
+			// switches the line to another baud rate, the timing follows the new rate
+			void set_baud_rate(std::uint32_t baud_rate);
+			std::uint32_t get_baud_rate() const;
+			// the baud rate is locked when a device has answered at it,
+			// until then the devices probe the candidate rates of the options
+			bool is_baud_rate_locked() const;
+			void lock_baud_rate();
+
+			// runs a single step of the next due device
+			void run_once();
+			clock::time_point get_next_run_time() const;
+
+			// writes a command frame
+			// keeping the line silent for t-free after the last confirmation
+			void write_frame(const frame& command_frame);
+			void write_frame(const extended_frame& command_frame);
+			// reads a response frame within the response window,
+			// returns false if the device has not responded in time;
+			// the line errors are recorded to the statistics of the device waiting for the response
+			bool read_frame(std::uint8_t& device_address, frame& payload, statistics_recorder& recorder);
+			// waits for the response longer than t-response, as a few commands take the device longer
+			bool read_frame(std::uint8_t& device_address, frame& payload, std::chrono::milliseconds response_timeout, statistics_recorder& recorder);
+			// reads a response which may be an extended frame
+			bool read_frame(std::uint8_t& device_address, extended_frame& payload, statistics_recorder& recorder);
+			void send_ack(std::uint8_t device_address);
+			void send_nak(std::uint8_t device_address);
+
+		private:
+			struct device_entry {
+				device_entry(bill_validator* device) :
+					device(device),
+					next_run_time() { }
+
+				bill_validator* device;
+				clock::time_point next_run_time;
+			};
+
+		private:
+			// the time the device is due, which is now if it has pending host commands
+			clock::time_point get_run_time(const device_entry& entry) const;
+			void write_bytes(const std::uint8_t* data, std::size_t size);
+			// receives the next frame to the response, or to the parser if it is an extended one,
+			// returns incomplete if the device has not responded in time
+			frame_parser::result receive_frame(frame& response, std::chrono::milliseconds response_timeout, statistics_recorder& recorder);
+			void send_confirmation(std::uint8_t device_address, std::uint8_t confirmation);
+			// the time it takes to put the bytes on the line
+			std::chrono::microseconds get_transmit_time(std::size_t bytes_count) const;
+			// the maximum time it may take to receive the bytes from the device
+			std::chrono::microseconds get_receive_time(std::size_t bytes_count) const;
+
+		private:
+			const connection_options options;
+			std::uint32_t baud_rate;
+			bool baud_rate_locked;
+			std::unique_ptr<serial_transport> transport;
+			frame_parser parser;
+			// the earliest time the next command may be sent
+			clock::time_point line_free_time;
+			std::vector<device_entry> devices;
+			// the device to start looking for a due one from
+			std::size_t next_device_index;
+	};
+
+}
+
+#endif // CCNET_BUS_H
@@ -0,0 +1,181 @@
+#include "bus_manager.h"
+#include <algorithm>
+#include <stdexcept>
+#include "bus.h"
+#include "request_pool.h"
+
+using namespace boost::asio;
+using namespace ccnet;
+
+// at most one wakeup handler is pending at a time
+const std::size_t wakeup_blocks_count = 2;
+const std::size_t wakeup_block_size = 256;
+
+bus_manager::bus_manager(std::size_t workers_count) :
+	io_service(),
+	io_service_work(make_work_guard(io_service)),
+	io_thread(),
+	workers(),
+	buses_by_port_names(),
+	busy_buses(),
+	waiting_changes_count(0),
+	scheduler_mutex(),
+	scheduler_condition(),
+	is_working(true),
+	wakeup_pending(false),
+	wakeup_blocks(std::make_shared<block_pool>(wakeup_block_size, wakeup_blocks_count)) {
+	if (workers_count == 0) {
+		throw std::runtime_error("invalid arguments");
+	}
+
+	this->busy_buses.reserve(workers_count);
+
+	try {
+		this->io_thread = std::thread([this]() { this->io_service.run(); });
+
+		for (std::size_t i = 0; i < workers_count; ++i) {
+			this->workers.push_back(std::thread(&bus_manager::work, this));
+		}
+	} catch (std::system_error) {
+		this->stop();
+		throw std::runtime_error("unable to create handler thread");
+	}
+}
+
+bus_manager::~bus_manager() {
+	this->stop();
+}
+
+void bus_manager::stop() {
+	{
+		std::lock_guard<std::mutex> lock(this->scheduler_mutex);
+		this->is_working = false;
+	}
+	this->scheduler_condition.notify_all();
+
+	for (std::vector<std::thread>::iterator iter = this->workers.begin(); iter != this->workers.end(); ++iter) {
+		if (iter->joinable()) {
+			iter->join();
+		}
+	}
+
+	this->io_service_work.reset();
+	if (this->io_thread.joinable()) {
+		this->io_thread.join();
+	}
+}
+
+void bus_manager::attach(const std::string& port_name, const connection_options& options, bill_validator* device) {
+	std::unique_lock<std::mutex> lock(this->scheduler_mutex);
+
+	std::unique_ptr<bus>& device_bus = this->buses_by_port_names[port_name];
+	if (!device_bus) {
+		try {
+			device_bus.reset(new bus(this->io_service, port_name, options));
+		} catch (...) {
+			this->buses_by_port_names.erase(port_name);
+			throw;
+		}
+	} else if (device_bus->get_options() != options) {
+		throw std::runtime_error("serial line is open with different options");
+	}
+
+	bus* attached_bus = device_bus.get();
+	this->wait_idle(lock, attached_bus);
+	attached_bus->attach(device);
+
+	lock.unlock();
+	this->scheduler_condition.notify_all();
+}
+
+void bus_manager::detach(bus* device_bus, bill_validator* device) {
+	std::unique_lock<std::mutex> lock(this->scheduler_mutex);
+
+	// the device may be in the middle of an exchange
+	this->wait_idle(lock, device_bus);
+	device_bus->detach(device);
+
+	if (device_bus->is_empty()) {
+		// close the line
+		for (std::map<std::string, std::unique_ptr<bus>>::iterator iter = this->buses_by_port_names.begin(); iter != this->buses_by_port_names.end(); ++iter) {
+			if (iter->second.get() == device_bus) {
+				this->buses_by_port_names.erase(iter);
+				break;
+			}
+		}
+	}
+
+	lock.unlock();
+	this->scheduler_condition.notify_all();
+}
+
+void bus_manager::notify() {
+	// the I/O thread takes the scheduler lock, so the caller never waits for a worker;
+	// the notifications are coalesced while a wakeup is pending
+	if (!this->wakeup_pending.exchange(true, std::memory_order_acq_rel)) {
+		// the handler memory is taken from a preallocated pool instead of the heap
+		post(this->io_service, make_pooled_handler([this]() {
+			// the commands queued before this point are seen by the workers
+			this->wakeup_pending.exchange(false, std::memory_order_acq_rel);
+
+			std::lock_guard<std::mutex> lock(this->scheduler_mutex);
+			this->scheduler_condition.notify_all();
+		}, this->wakeup_blocks));
+	}
+}
+
+void bus_manager::work() {
+	std::unique_lock<std::mutex> lock(this->scheduler_mutex);
+
+	while (this->is_working) {
+		if (this->waiting_changes_count != 0) {
+			// let the devices be attached or detached first
+			this->scheduler_condition.wait(lock);
+			continue;
+		}
+
+		bus* next_bus = nullptr;
+		bus::clock::time_point next_run_time = bus::clock::time_point::max();
+
+		// find the idle bus with the earliest due device
+		for (std::map<std::string, std::unique_ptr<bus>>::const_iterator iter = this->buses_by_port_names.cbegin(); iter != this->buses_by_port_names.cend(); ++iter) {
+			bus* current_bus = iter->second.get();
+
+			if ((!this->is_busy(current_bus)) && (current_bus->get_next_run_time() < next_run_time)) {
+				next_bus = current_bus;
+				next_run_time = current_bus->get_next_run_time();
+			}
+		}
+
+		if (next_bus == nullptr) {
+			this->scheduler_condition.wait(lock);
+			continue;
+		}
+
+		if (next_run_time > bus::clock::now()) {
+			this->scheduler_condition.wait_until(lock, next_run_time);
+			continue;
+		}
+
+		this->busy_buses.push_back(next_bus);
+		lock.unlock();
+
+		next_bus->run_once();
+
+		lock.lock();
+		this->busy_buses.erase(std::find(this->busy_buses.begin(), this->busy_buses.end(), next_bus));
+		this->scheduler_condition.notify_all();
+	}
+}
+
+void bus_manager::wait_idle(std::unique_lock<std::mutex>& lock, const bus* device_bus) {
+	// a bus polled without a pause is taken by a worker again as soon as it is released,
+	// so no worker starts a bus until the change is made
+	++this->waiting_changes_count;
+	this->scheduler_condition.wait(lock, [this, device_bus]() { return !this->is_busy(device_bus); });
+	--this->waiting_changes_count;
+}
+
+bool bus_manager::is_busy(const bus* device_bus) const {
+	return std::find(this->busy_buses.cbegin(), this->busy_buses.cend(), device_bus) != this->busy_buses.cend();
+}
@@ -1,8 +1,17 @@
 #include "cash_type.h"
+#include <stdexcept>
+#include <type_traits>
+
+using namespace ccnet;
+
+static_assert(std::is_trivially_copyable<cash_type>::value, "cash type has to be trivially copyable");
+static_assert(sizeof(cash_type) <= 16, "cash type has to fit 16 bytes");
+
+// the comparisons are made on both fields at once without branching
 
 bool ccnet::operator==(const cash_type& lhs, const cash_type& rhs) {
-	return (lhs.currency_code == rhs.currency_code)
-		&& (lhs.denomination == rhs.denomination);
+	return (lhs.packed_currency_code == rhs.packed_currency_code)
+		& (lhs.denomination == rhs.denomination);
 }
 
 bool ccnet::operator!=(const cash_type& lhs, const cash_type& rhs) {
@@ -10,25 +19,55 @@ bool ccnet::operator!=(const cash_type& lhs, const cash_type& rhs) {
 }
 
 bool ccnet::operator<(const cash_type& lhs, const cash_type& rhs) {
-	if (lhs.currency_code != rhs.currency_code) {
-		return lhs.currency_code < rhs.currency_code;
-	}
-
-	return lhs.denomination < rhs.denomination;
+	return (lhs.packed_currency_code < rhs.packed_currency_code)
+		| ((lhs.packed_currency_code == rhs.packed_currency_code) & (lhs.denomination < rhs.denomination));
 }
 
 bool ccnet::operator>(const cash_type& lhs, const cash_type& rhs) {
-	if (lhs.currency_code != rhs.currency_code) {
-		return lhs.currency_code > rhs.currency_code;
-	}
-
-	return lhs.denomination > rhs.denomination;
+	return rhs < lhs;
 }
 
 bool ccnet::operator<=(const cash_type& lhs, const cash_type& rhs) {
-	return (lhs < rhs) || (lhs == rhs);
+	return !(rhs < lhs);
 }
 
 bool ccnet::operator>=(const cash_type& lhs, const cash_type& rhs) {
-	return (lhs > rhs) || (lhs == rhs);
+	return !(lhs < rhs);
+}
+
+std::uint32_t cash_type::pack_currency_code(const std::string& currency_code) {
+	return pack_currency_code(currency_code.data(), currency_code.size());
+}
+
+std::uint32_t cash_type::pack_currency_code(const char* currency_code, std::size_t size) {
+	// a longer code would be truncated and compare equal to another currency
+	if (size != currency_code_size) {
+		throw std::runtime_error("invalid currency code");
+	}
+
+	std::uint32_t packed_currency_code = 0;
+
+	for (std::size_t i = 0; i < currency_code_size; ++i) {
+		packed_currency_code = (packed_currency_code << 8) | (std::uint8_t)currency_code[i];
+	}
+
+	return packed_currency_code;
+}
+
+std::string cash_type::get_currency_code() const {
+	std::string currency_code;
+
+	for (std::size_t i = currency_code_size; i > 0; --i) {
+		const char letter = (char)((this->packed_currency_code >> ((i - 1) * 8)) & 0xff);
+
+		if (letter != '\0') {
+			currency_code += letter;
+		}
+	}
+
+	return currency_code;
+}
+
+void cash_type::set_currency_code(const std::string& currency_code) {
+	this->packed_currency_code = pack_currency_code(currency_code);
 }
@@ -0,0 +1,280 @@
+#include "codec.h"
+#include <algorithm>
+#include <stdexcept>
+#include "utility.h"
+
+using namespace ccnet;
+
+const std::uint8_t byte_size = 8;
+
+const std::uint64_t currency_base = 10;
+const std::uint8_t exponent_sign_bit_number = 7;
+
+const std::uint8_t bill_types_count_max = bill_table_index::bill_types_count_max;
+const std::size_t bill_type_record_size = 5;
+
+// the REQUEST STATISTICS response blocks
+const std::size_t statistics_identification_size = 32;
+const std::size_t statistics_reset_time_offset = 5;
+const std::size_t first_aggregate_set_size = 179;
+const std::size_t second_aggregate_size = 20 * 66;
+const std::size_t third_aggregate_size = 20 * 1;
+const std::size_t statistics_denominations_size = device_counters::denominations_count * bill_type_record_size;
+const std::size_t currency_names_size = 20;
+// the counters of the first aggregate sets
+const std::size_t bill_counter_size = 2;
+const std::size_t event_counter_size = 1;
+// the bits of the first byte of a denominations table record below the denomination type
+const std::uint8_t denomination_digit_mask = 0x3f;
+// the error response sent instead of the damaged statistics
+const std::uint8_t invalid_statistics_data = 0x31;
+
+// result data sizes in bytes
+const std::size_t get_bill_table_result_data_size = bill_types_count_max * bill_type_record_size;
+const std::size_t get_status_result_data_size = 6;
+const std::size_t request_statistics_result_data_size = statistics_identification_size
+	+ statistics_report::sets_count * first_aggregate_set_size + second_aggregate_size + third_aggregate_size
+	+ statistics_denominations_size + currency_names_size;
+
+// decodes a bill table record: the most significant digit of the denomination,
+// the country code and the decimal exponent
+cash_type decode_cash_type(std::uint8_t digit, const std::uint8_t* record) {
+	// TODO: country to currency mapping required
+	const std::uint32_t currency_code = cash_type::pack_currency_code(reinterpret_cast<const char*>(record + 1), cash_type::currency_code_size);
+
+	const std::uint64_t minor_currency_units_per_major = 100; // currency: RUB
+	std::uint64_t denomination = 0;
+	if (is_bit_set(record[4], exponent_sign_bit_number)) {
+		denomination = digit * minor_currency_units_per_major;
+
+		if (denomination % (power(currency_base, get_abs_exponent(record[4]))) != 0) {
+			throw std::runtime_error("invalid cash type");
+		}
+
+		denomination /= (power(currency_base, get_abs_exponent(record[4])));
+	} else {
+		denomination = digit * minor_currency_units_per_major;
+		denomination *= (power(currency_base, get_abs_exponent(record[4])));
+	}
+
+	cash_type bill_type;
+	bill_type.denomination = denomination;
+	bill_type.packed_currency_code = currency_code;
+	return bill_type;
+}
+
+// takes a big-endian counter of the size at the offset and moves past it
+std::uint64_t take_counter(const std::uint8_t* data, std::size_t& offset, std::size_t size) {
+	std::uint64_t value = 0;
+	for (std::size_t i = 0; i < size; ++i) {
+		value = (value << byte_size) | data[offset + i];
+	}
+
+	offset += size;
+	return value;
+}
+
+device_counters decode_counters_set(const std::uint8_t* data) {
+	device_counters counters;
+	std::size_t offset = 0;
+
+	counters.bills_inserted_count = take_counter(data, offset, bill_counter_size);
+	for (std::size_t i = 0; i < device_counters::denominations_count; ++i) {
+		counters.bills_accepted_counts[i] = take_counter(data, offset, bill_counter_size);
+	}
+	for (std::size_t i = 0; i < device_counters::denominations_count; ++i) {
+		counters.optical_returns_counts[i] = take_counter(data, offset, bill_counter_size);
+	}
+	for (std::size_t i = 0; i < device_counters::denominations_count; ++i) {
+		counters.magnetic_returns_counts[i] = take_counter(data, offset, bill_counter_size);
+	}
+	for (std::size_t i = 0; i < device_counters::denominations_count; ++i) {
+		counters.capacitance_returns_counts[i] = take_counter(data, offset, bill_counter_size);
+	}
+	counters.unrecognized_bills_count = take_counter(data, offset, bill_counter_size);
+	counters.length_returns_count = take_counter(data, offset, bill_counter_size);
+
+	counters.magnetic_failures_count = take_counter(data, offset, event_counter_size);
+	counters.optical_failures_count = take_counter(data, offset, event_counter_size);
+	counters.transport_failures_count = take_counter(data, offset, event_counter_size);
+	counters.stacking_failures_count = take_counter(data, offset, event_counter_size);
+	counters.aligning_failures_count = take_counter(data, offset, event_counter_size);
+	for (std::size_t i = 0; i < device_counters::jam_places_count; ++i) {
+		counters.jams_counts[i] = take_counter(data, offset, event_counter_size);
+	}
+
+	return counters;
+}
+
+// applies the function to the pairs of the counters, the denominations are left alone
+template<typename Function>
+void combine_counters(device_counters& target, const device_counters& source, Function function) {
+	function(target.bills_inserted_count, source.bills_inserted_count);
+	for (std::size_t i = 0; i < device_counters::denominations_count; ++i) {
+		function(target.bills_accepted_counts[i], source.bills_accepted_counts[i]);
+		function(target.optical_returns_counts[i], source.optical_returns_counts[i]);
+		function(target.magnetic_returns_counts[i], source.magnetic_returns_counts[i]);
+		function(target.capacitance_returns_counts[i], source.capacitance_returns_counts[i]);
+	}
+	function(target.unrecognized_bills_count, source.unrecognized_bills_count);
+	function(target.length_returns_count, source.length_returns_count);
+	function(target.magnetic_failures_count, source.magnetic_failures_count);
+	function(target.optical_failures_count, source.optical_failures_count);
+	function(target.transport_failures_count, source.transport_failures_count);
+	function(target.stacking_failures_count, source.stacking_failures_count);
+	function(target.aligning_failures_count, source.aligning_failures_count);
+	for (std::size_t i = 0; i < device_counters::jam_places_count; ++i) {
+		function(target.jams_counts[i], source.jams_counts[i]);
+	}
+}
+
+bool are_counters_equal(const device_counters& lhs, const device_counters& rhs) {
+	device_counters target = lhs;
+	bool is_equal = true;
+	combine_counters(target, rhs, [&is_equal](std::uint64_t& lhs_value, std::uint64_t rhs_value) { is_equal = is_equal && (lhs_value == rhs_value); });
+	return is_equal;
+}
+
+// whether every counter of the set has only grown since
+bool has_grown_from(const device_counters& current, const device_counters& previous) {
+	device_counters target = current;
+	bool has_grown = true;
+	combine_counters(target, previous, [&has_grown](std::uint64_t& current_value, std::uint64_t previous_value) { has_grown = has_grown && (current_value >= previous_value); });
+	return has_grown;
+}
+
+// sums the sets starting from the first one, the current set is the last one
+device_counters sum_counters(const statistics_report& report, std::size_t first_set_number) {
+	device_counters sum;
+	for (std::size_t i = first_set_number; i < statistics_report::sets_count; ++i) {
+		combine_counters(sum, report.sets[i], [](std::uint64_t& sum_value, std::uint64_t value) { sum_value += value; });
+	}
+
+	sum.denominations = report.denominations;
+	return sum;
+}
+
+std::map<std::uint8_t, cash_type> ccnet::decode_bill_table(const frame& bill_table) {
+	if (bill_table.size() != get_bill_table_result_data_size) {
+		throw std::runtime_error("invalid data received");
+	}
+
+	std::map<std::uint8_t, cash_type> bill_types_by_numbers;
+
+	for (std::uint8_t bill_type_number = 0; bill_type_number < bill_types_count_max; ++bill_type_number) {
+		const std::size_t offset = bill_type_number * bill_type_record_size;
+
+		if (bill_table[offset] == 0) {
+			continue;
+		}
+
+		bill_types_by_numbers[bill_type_number] = decode_cash_type(bill_table[offset], bill_table.data() + offset);
+	}
+
+	return bill_types_by_numbers;
+}
+
+std::set<cash_type> ccnet::decode_enabled_bill_types(const frame& status, const bill_table_index& bill_types) {
+	if (status.size() != get_status_result_data_size) {
+		throw std::runtime_error("invalid data received");
+	}
+
+	// the first mask of the response holds the enabled bill types
+	std::set<cash_type> enabled_bill_types;
+
+	for (std::uint8_t bill_type_number = 0; bill_type_number < bill_types_count_max; ++bill_type_number) {
+		const cash_type* bill_type = bill_types.find_cash_type(bill_type_number);
+
+		if ((bill_type != nullptr) && is_bill_type_bit_set(status.data(), bill_type_number)) {
+			enabled_bill_types.insert(*bill_type);
+		}
+	}
+
+	return enabled_bill_types;
+}
+
+std::map<cash_type, bill_security_level> ccnet::decode_bill_types_security_levels(const frame& status, const bill_table_index& bill_types) {
+	if (status.size() != get_status_result_data_size) {
+		throw std::runtime_error("invalid data received");
+	}
+
+	// the second mask of the response holds the bill types with the high security level,
+	// the bits of the numbers missing from the bill table are ignored
+	std::map<cash_type, bill_security_level> bill_types_security_levels;
+
+	for (std::uint8_t bill_type_number = 0; bill_type_number < bill_types_count_max; ++bill_type_number) {
+		const cash_type* bill_type = bill_types.find_cash_type(bill_type_number);
+
+		if (bill_type != nullptr) {
+			bill_types_security_levels[*bill_type] = is_bill_type_bit_set(status.data() + bill_types_mask_size, bill_type_number)
+				? bill_security_level::high
+				: bill_security_level::normal;
+		}
+	}
+
+	return bill_types_security_levels;
+}
+
+statistics_report ccnet::decode_statistics_report(const extended_frame& statistics) {
+	if ((statistics.size() == 1) && (statistics[0] == invalid_statistics_data)) {
+		throw std::runtime_error("invalid statistics data");
+	}
+
+	if (statistics.size() != request_statistics_result_data_size) {
+		throw std::runtime_error("invalid data received");
+	}
+
+	statistics_report report;
+	std::copy_n(statistics.cbegin() + statistics_reset_time_offset, statistics_report::reset_time_size, report.reset_time.begin());
+
+	const std::uint8_t* sets_data = statistics.data() + statistics_identification_size;
+	for (std::size_t i = 0; i < statistics_report::sets_count; ++i) {
+		report.sets[i] = decode_counters_set(sets_data + i * first_aggregate_set_size);
+	}
+
+	const std::uint8_t* denominations_data = sets_data + statistics_report::sets_count * first_aggregate_set_size + second_aggregate_size + third_aggregate_size;
+	for (std::size_t i = 0; i < device_counters::denominations_count; ++i) {
+		const std::uint8_t* record = denominations_data + i * bill_type_record_size;
+		const std::uint8_t digit = record[0] & denomination_digit_mask;
+
+		if (digit != 0) {
+			report.denominations[i] = decode_cash_type(digit, record);
+		}
+	}
+
+	return report;
+}
+
+device_counters ccnet::get_counters_delta(const statistics_report& current, const statistics_report& previous) {
+	const std::size_t last_set_number = statistics_report::sets_count - 1;
+
+	if (current.reset_time != previous.reset_time) {
+		return sum_counters(current, 0);
+	}
+
+	// the sets completed before the previous report have moved towards the first one
+	// by the number of the sets started since then
+	for (std::size_t started_sets_count = 0; started_sets_count < statistics_report::sets_count; ++started_sets_count) {
+		bool is_matching = has_grown_from(current.sets[last_set_number - started_sets_count], previous.sets[last_set_number]);
+		for (std::size_t i = started_sets_count; is_matching && (i < last_set_number); ++i) {
+			is_matching = are_counters_equal(current.sets[i - started_sets_count], previous.sets[i]);
+		}
+
+		if (is_matching) {
+			device_counters delta = sum_counters(current, last_set_number - started_sets_count);
+			combine_counters(delta, previous.sets[last_set_number], [](std::uint64_t& delta_value, std::uint64_t previous_value) { delta_value -= previous_value; });
+			return delta;
+		}
+	}
+
+	// the history does not continue the previous one
+	return sum_counters(current, 0);
+}
+
+void ccnet::set_bill_type_bit(std::uint8_t* mask, std::uint8_t bill_type_number) {
+	set_bit(mask[bill_types_mask_size - 1 - (bill_type_number / byte_size)], bill_type_number % byte_size);
+}
+
+bool ccnet::is_bill_type_bit_set(const std::uint8_t* mask, std::uint8_t bill_type_number) {
+	return is_bit_set(mask[bill_types_mask_size - 1 - (bill_type_number / byte_size)], bill_type_number % byte_size);
+}
@@ -0,0 +1,59 @@
+#ifndef CCNET_CODEC_H
+#define CCNET_CODEC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include "bill_table_index.h"
+#include "ccnet.h"
+#include "device_counters.h"
+#include "frame.h"
+
+namespace ccnet {
+
+	// the size of a bill type mask in the GET STATUS, ENABLE BILL TYPES and SET SECURITY data
+	const std::size_t bill_types_mask_size = 3;
+
+	// decodes the data of the GET BILL TABLE response
+	// into the cash types by the bill type numbers
+	std::map<std::uint8_t, cash_type> decode_bill_table(const frame& bill_table);
+
+	// decode the bill type masks of the GET STATUS response
+	std::set<cash_type> decode_enabled_bill_types(const frame& status, const bill_table_index& bill_types);
+	std::map<cash_type, bill_security_level> decode_bill_types_security_levels(const frame& status, const bill_table_index& bill_types);
+
+	// the REQUEST STATISTICS response
+	struct statistics_report {
+		static const std::size_t sets_count = 16;
+		static const std::size_t reset_time_size = 7;
+
+		statistics_report() :
+			reset_time(),
+			sets(),
+			denominations() { }
+
+		// the time the device has reset the statistics at, as it encodes the time
+		std::array<std::uint8_t, reset_time_size> reset_time;
+		// the sets of 10000 inserted bills, the current one last and the zeroed ones not used yet first
+		std::array<device_counters, sets_count> sets;
+		std::array<cash_type, device_counters::denominations_count> denominations;
+	};
+
+	// decodes the data of the REQUEST STATISTICS response: the identification block,
+	// the aggregates of the sets of 10000, 500 and 50 inserted bills, the denominations table
+	// and the currency names; the finer aggregates cover the latest bills of the same history
+	// and are not decoded, the counters are sent most significant byte first
+	statistics_report decode_statistics_report(const extended_frame& statistics);
+	// the counters added between the reports: the growth of the set which was current
+	// and the sets started since then, all the counters if the history has been reset
+	device_counters get_counters_delta(const statistics_report& current, const statistics_report& previous);
+
+	// marks the bill type in a mask sent with the most significant byte first
+	void set_bill_type_bit(std::uint8_t* mask, std::uint8_t bill_type_number);
+	bool is_bill_type_bit_set(const std::uint8_t* mask, std::uint8_t bill_type_number);
+
+}
+
+#endif // CCNET_CODEC_H
@@ -0,0 +1,19 @@
+#include "connection_options.h"
+
+bool ccnet::operator==(const connection_options& lhs, const connection_options& rhs) {
+	return (lhs.baud_rate == rhs.baud_rate)
+		&& (lhs.character_size == rhs.character_size)
+		&& (lhs.parity == rhs.parity)
+		&& (lhs.stop_bits == rhs.stop_bits)
+		&& (lhs.response_timeout == rhs.response_timeout)
+		&& (lhs.inter_byte_timeout == rhs.inter_byte_timeout)
+		&& (lhs.free_line_time == rhs.free_line_time)
+		&& (lhs.adapter_latency == rhs.adapter_latency)
+		&& (lhs.transport == rhs.transport)
+		&& (lhs.probe_baud_rates == rhs.probe_baud_rates)
+		&& ((bool)lhs.custom_transport == (bool)rhs.custom_transport);
+}
+
+bool ccnet::operator!=(const connection_options& lhs, const connection_options& rhs) {
+	return !(lhs == rhs);
+}
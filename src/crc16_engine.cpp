@@ -0,0 +1,84 @@
+#include "crc16_engine.h"
+
+using namespace ccnet;
+
+namespace {
+
+	const std::uint16_t polynomial = 0x8408;
+
+	// number of lookup tables used by the slicing algorithm
+	const std::size_t slices_count = 8;
+
+	struct crc16_tables {
+		// values[0] is the classic byte-wise table,
+		// values[k][i] is the crc of byte i followed by k zero bytes
+		std::uint16_t values[slices_count][256];
+	};
+
+	constexpr crc16_tables make_crc16_tables() {
+		crc16_tables tables {};
+
+		for (std::uint16_t byte = 0; byte < 256; ++byte) {
+			std::uint16_t crc = byte;
+
+			for (std::uint8_t bit_number = 0; bit_number < 8; ++bit_number) {
+				crc = (crc & 0x0001) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+			}
+
+			tables.values[0][byte] = crc;
+		}
+
+		for (std::size_t slice = 1; slice < slices_count; ++slice) {
+			for (std::uint16_t byte = 0; byte < 256; ++byte) {
+				const std::uint16_t previous = tables.values[slice - 1][byte];
+				tables.values[slice][byte] = (previous >> 8) ^ tables.values[0][previous & 0xFF];
+			}
+		}
+
+		return tables;
+	}
+
+	constexpr crc16_tables tables = make_crc16_tables();
+
+	inline std::uint16_t step(std::uint16_t crc, std::uint8_t byte) {
+		return (crc >> 8) ^ tables.values[0][(crc ^ byte) & 0xFF];
+	}
+
+}
+
+crc16_engine& crc16_engine::update(const std::uint8_t* data, std::size_t size) {
+	std::uint16_t crc = this->value;
+
+	// slice-by-8 for the bulk of the data
+	while (size >= 8) {
+		crc ^= (std::uint16_t)(data[0] | (data[1] << 8));
+		crc = tables.values[7][crc & 0xFF] ^ tables.values[6][crc >> 8]
+			^ tables.values[5][data[2]] ^ tables.values[4][data[3]]
+			^ tables.values[3][data[4]] ^ tables.values[2][data[5]]
+			^ tables.values[1][data[6]] ^ tables.values[0][data[7]];
+		data += 8;
+		size -= 8;
+	}
+
+	// slice-by-4 for the remainder
+	if (size >= 4) {
+		crc ^= (std::uint16_t)(data[0] | (data[1] << 8));
+		crc = tables.values[3][crc & 0xFF] ^ tables.values[2][crc >> 8]
+			^ tables.values[1][data[2]] ^ tables.values[0][data[3]];
+		data += 4;
+		size -= 4;
+	}
+
+	// byte-wise tail
+	for (std::size_t i = 0; i < size; ++i) {
+		crc = step(crc, data[i]);
+	}
+
+	this->value = crc;
+	return *this;
+}
+
+crc16_engine& crc16_engine::update_byte(std::uint8_t byte) {
+	this->value = step(this->value, byte);
+	return *this;
+}
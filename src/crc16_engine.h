@@ -0,0 +1,53 @@
+#ifndef CCNET_CRC16_ENGINE_H
+#define CCNET_CRC16_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ccnet {
+
+	// table-driven CRC16 (polynomial 0x8408, initial value 0)
+	// used as the frame check sequence of CCNET frames;
+	// the checksum may be computed incrementally while bytes arrive
+	class crc16_engine {
+		public:
+			typedef std::uint16_t value_type;
+
+			crc16_engine() :
+				value(0) { }
+
+			// processes a contiguous block of bytes
+			crc16_engine& update(const std::uint8_t* data, std::size_t size);
+
+			// processes any contiguous byte container (std::vector, std::array, frame, ...)
+			template<typename ContiguousBytes>
+			crc16_engine& update(const ContiguousBytes& bytes) {
+				return this->update(bytes.data(), bytes.size());
+			}
+
+			crc16_engine& update_byte(std::uint8_t byte);
+
+			value_type get_value() const {
+				return this->value;
+			}
+
+			void reset() {
+				this->value = 0;
+			}
+
+			static value_type compute(const std::uint8_t* data, std::size_t size) {
+				return crc16_engine().update(data, size).get_value();
+			}
+
+			template<typename ContiguousBytes>
+			static value_type compute(const ContiguousBytes& bytes) {
+				return compute(bytes.data(), bytes.size());
+			}
+
+		private:
+			value_type value;
+	};
+
+}
+
+#endif // CCNET_CRC16_ENGINE_H
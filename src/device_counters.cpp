@@ -0,0 +1,24 @@
+#include "device_counters.h"
+#include <numeric>
+
+using namespace ccnet;
+
+std::uint64_t device_counters::get_bills_accepted_count() const {
+	return std::accumulate(this->bills_accepted_counts.cbegin(), this->bills_accepted_counts.cend(), (std::uint64_t)0);
+}
+
+std::uint64_t device_counters::get_bills_rejected_count() const {
+	return std::accumulate(this->optical_returns_counts.cbegin(), this->optical_returns_counts.cend(), (std::uint64_t)0)
+		+ std::accumulate(this->magnetic_returns_counts.cbegin(), this->magnetic_returns_counts.cend(), (std::uint64_t)0)
+		+ std::accumulate(this->capacitance_returns_counts.cbegin(), this->capacitance_returns_counts.cend(), (std::uint64_t)0)
+		+ this->unrecognized_bills_count
+		+ this->length_returns_count;
+}
+
+std::uint64_t device_counters::get_motor_failures_count() const {
+	return this->transport_failures_count + this->stacking_failures_count + this->aligning_failures_count;
+}
+
+std::uint64_t device_counters::get_jams_count() const {
+	return std::accumulate(this->jams_counts.cbegin(), this->jams_counts.cend(), (std::uint64_t)0);
+}
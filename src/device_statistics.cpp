@@ -0,0 +1,29 @@
+#include "device_statistics.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace ccnet;
+
+std::chrono::microseconds latency_histogram::get_quantile(double quantile) const {
+	if (this->count == 0) {
+		return std::chrono::microseconds(0);
+	}
+
+	// the number of the latencies not exceeding the quantile
+	const std::uint64_t rank = std::min(std::max((std::uint64_t)std::ceil(std::max(quantile, 0.0) * this->count), (std::uint64_t)1), this->count);
+	std::uint64_t accumulated_count = 0;
+
+	for (std::size_t i = 0; i < this->buckets.size(); ++i) {
+		accumulated_count += this->buckets[i];
+
+		if (accumulated_count >= rank) {
+			return std::chrono::microseconds((std::uint64_t)1 << (i + 1));
+		}
+	}
+
+	return std::chrono::microseconds((std::uint64_t)1 << buckets_count);
+}
+
+std::chrono::microseconds latency_histogram::get_average() const {
+	return (this->count == 0) ? std::chrono::microseconds(0) : this->total_latency / (std::int64_t)this->count;
+}
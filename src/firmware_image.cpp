@@ -0,0 +1,45 @@
+#include "firmware_image.h"
+#include <stdexcept>
+#include <boost/crc.hpp>
+
+using namespace boost::interprocess;
+using namespace ccnet;
+
+firmware_image::firmware_image(const std::string& path, const firmware_progress_handler& progress_handler) :
+	file(),
+	region(),
+	crc32(0),
+	progress_handler(progress_handler) {
+	try {
+		this->file = file_mapping(path.c_str(), read_only);
+		this->region = mapped_region(this->file, read_only);
+	} catch (interprocess_exception) {
+		// the empty files cannot be mapped either
+		throw std::runtime_error("unable to map firmware image");
+	}
+
+	// the image is read through once
+	this->region.advise(mapped_region::advice_sequential);
+
+	boost::crc_32_type crc;
+	crc.process_bytes(this->region.get_address(), this->region.get_size());
+	this->crc32 = crc.checksum();
+}
+
+const std::uint8_t* firmware_image::data() const {
+	return static_cast<const std::uint8_t*>(this->region.get_address());
+}
+
+std::size_t firmware_image::size() const {
+	return this->region.get_size();
+}
+
+std::uint32_t firmware_image::get_crc32() const {
+	return this->crc32;
+}
+
+void firmware_image::report_progress(std::size_t downloaded_size) const {
+	if (this->progress_handler) {
+		this->progress_handler(downloaded_size, this->size());
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef CCNET_FIRMWARE_IMAGE_H
+#define CCNET_FIRMWARE_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "firmware_update.h"
+
+namespace ccnet {
+
+	// a firmware image mapped into memory from a file,
+	// the pages are read by the system as the blocks are downloaded
+	class firmware_image {
+		public:
+			firmware_image(const std::string& path, const firmware_progress_handler& progress_handler);
+
+			firmware_image(const firmware_image& other) = delete;
+
+			firmware_image& operator=(const firmware_image& other) = delete;
+
+			const std::uint8_t* data() const;
+			std::size_t size() const;
+			// the CRC32 the device reports for the image once it is downloaded
+			std::uint32_t get_crc32() const;
+			void report_progress(std::size_t downloaded_size) const;
+
+		private:
+			boost::interprocess::file_mapping file;
+			boost::interprocess::mapped_region region;
+			std::uint32_t crc32;
+			firmware_progress_handler progress_handler;
+	};
+
+}
+
+#endif // CCNET_FIRMWARE_IMAGE_H
@@ -0,0 +1,49 @@
+#include "frame.h"
+#include <stdexcept>
+#include "crc16_engine.h"
+#include "protocol.h"
+
+using namespace ccnet;
+
+void ccnet::encode_frame(frame& encoded_frame, std::uint8_t device_address, std::uint8_t code, const std::uint8_t* data, std::size_t data_size) {
+	const std::size_t frame_size = header_size + 1 + data_size + sizeof(std::uint16_t);
+
+	if (frame_size > frame::capacity) {
+		throw std::runtime_error("frame is too long");
+	}
+
+	encoded_frame.clear();
+	encoded_frame.push_back(sync);
+	encoded_frame.push_back(device_address);
+	encoded_frame.push_back((std::uint8_t)frame_size);
+	encoded_frame.push_back(code);
+	encoded_frame.append(data, data_size);
+
+	// add the frame check sequence
+	const std::uint16_t crc = crc16_engine::compute(encoded_frame);
+	encoded_frame.push_back((std::uint8_t)(crc & 0xFF));
+	encoded_frame.push_back((std::uint8_t)(crc >> 8));
+}
+
+void ccnet::encode_extended_frame(extended_frame& encoded_frame, std::uint8_t device_address, const std::uint8_t* prefix, std::size_t prefix_size, const std::uint8_t* data, std::size_t data_size) {
+	const std::size_t frame_size = header_size + prefix_size + extended_length_size + data_size + sizeof(std::uint16_t);
+
+	if (frame_size > extended_frame_size_max) {
+		throw std::runtime_error("frame is too long");
+	}
+
+	encoded_frame.clear();
+	encoded_frame.reserve(frame_size);
+	encoded_frame.push_back(sync);
+	encoded_frame.push_back(device_address);
+	encoded_frame.push_back(extended_lng);
+	encoded_frame.insert(encoded_frame.end(), prefix, prefix + prefix_size);
+	encoded_frame.push_back((std::uint8_t)(frame_size >> 8));
+	encoded_frame.push_back((std::uint8_t)(frame_size & 0xFF));
+	encoded_frame.insert(encoded_frame.end(), data, data + data_size);
+
+	// add the frame check sequence
+	const std::uint16_t crc = crc16_engine::compute(encoded_frame.data(), encoded_frame.size());
+	encoded_frame.push_back((std::uint8_t)(crc & 0xFF));
+	encoded_frame.push_back((std::uint8_t)(crc >> 8));
+}
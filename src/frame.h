@@ -0,0 +1,151 @@
+#ifndef CCNET_FRAME_H
+#define CCNET_FRAME_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace ccnet {
+
+	// a fixed-capacity byte buffer holding a CCNET frame or a part of it;
+	// the length byte limits a frame to 255 bytes, so it always fits on the stack
+	class frame {
+		public:
+			typedef std::uint8_t value_type;
+			typedef std::uint8_t* iterator;
+			typedef const std::uint8_t* const_iterator;
+			typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+			static const std::size_t capacity = 255;
+
+			frame() :
+				bytes(),
+				bytes_count(0) { }
+
+			explicit frame(std::size_t size) :
+				bytes(),
+				bytes_count(0) {
+				this->resize(size);
+			}
+
+			frame(const_iterator first, const_iterator last) :
+				bytes(),
+				bytes_count(0) {
+				this->append(first, last - first);
+			}
+
+			std::uint8_t* data() {
+				return this->bytes.data();
+			}
+
+			const std::uint8_t* data() const {
+				return this->bytes.data();
+			}
+
+			std::size_t size() const {
+				return this->bytes_count;
+			}
+
+			bool empty() const {
+				return this->bytes_count == 0;
+			}
+
+			std::uint8_t& operator[](std::size_t index) {
+				return this->bytes[index];
+			}
+
+			std::uint8_t operator[](std::size_t index) const {
+				return this->bytes[index];
+			}
+
+			iterator begin() {
+				return this->bytes.data();
+			}
+
+			iterator end() {
+				return this->bytes.data() + this->bytes_count;
+			}
+
+			const_iterator begin() const {
+				return this->cbegin();
+			}
+
+			const_iterator end() const {
+				return this->cend();
+			}
+
+			const_iterator cbegin() const {
+				return this->bytes.data();
+			}
+
+			const_iterator cend() const {
+				return this->bytes.data() + this->bytes_count;
+			}
+
+			const_reverse_iterator crbegin() const {
+				return const_reverse_iterator(this->cend());
+			}
+
+			const_reverse_iterator crend() const {
+				return const_reverse_iterator(this->cbegin());
+			}
+
+			void clear() {
+				this->bytes_count = 0;
+			}
+
+			// new bytes are zeroed
+			void resize(std::size_t size) {
+				if (size > capacity) {
+					throw std::runtime_error("frame is too long");
+				}
+
+				if (size > this->bytes_count) {
+					std::fill(this->bytes.begin() + this->bytes_count, this->bytes.begin() + size, 0);
+				}
+
+				this->bytes_count = size;
+			}
+
+			void push_back(std::uint8_t byte) {
+				if (this->bytes_count == capacity) {
+					throw std::runtime_error("frame is too long");
+				}
+
+				this->bytes[this->bytes_count++] = byte;
+			}
+
+			void append(const std::uint8_t* data, std::size_t size) {
+				if (this->bytes_count + size > capacity) {
+					throw std::runtime_error("frame is too long");
+				}
+
+				std::copy(data, data + size, this->bytes.begin() + this->bytes_count);
+				this->bytes_count += size;
+			}
+
+		private:
+			std::array<std::uint8_t, capacity> bytes;
+			std::size_t bytes_count;
+	};
+
+	// writes the header, the command or control byte, the data
+	// and the frame check sequence of a frame in place
+	void encode_frame(frame& encoded_frame, std::uint8_t device_address, std::uint8_t code, const std::uint8_t* data, std::size_t data_size);
+
+	// a frame longer than the length byte allows, up to 64 KiB;
+	// only the bulk transfers use them, so they are kept on the heap
+	typedef std::vector<std::uint8_t> extended_frame;
+
+	// writes an extended frame: the header with the zero length byte, the prefix,
+	// the two-byte length, the data and the frame check sequence;
+	// the prefix is the command and the subcommand of a controller frame and is empty in a response
+	void encode_extended_frame(extended_frame& encoded_frame, std::uint8_t device_address, const std::uint8_t* prefix, std::size_t prefix_size, const std::uint8_t* data, std::size_t data_size);
+
+}
+
+#endif // CCNET_FRAME_H
@@ -0,0 +1,232 @@
+#include "frame_parser.h"
+#include <algorithm>
+#include "crc16_engine.h"
+#include "protocol.h"
+
+using namespace ccnet;
+
+// the header, a command or control byte and the frame check sequence
+const std::size_t frame_size_min = header_size + 1 + sizeof(std::uint16_t);
+
+frame_parser::frame_parser(frame_sender sender) :
+	sender(sender),
+	buffer(),
+	read_position(0),
+	write_position(0),
+	is_synchronised(true),
+	sync_losses_count(0),
+	extended_frame_size(0),
+	extended_bytes() { }
+
+std::uint8_t* frame_parser::get_write_position() {
+	return this->buffer.data() + (this->write_position % buffer_capacity);
+}
+
+std::size_t frame_parser::get_write_size() const {
+	const std::size_t free_size = buffer_capacity - (this->write_position - this->read_position);
+	const std::size_t size_to_end = buffer_capacity - (this->write_position % buffer_capacity);
+
+	return std::min(free_size, size_to_end);
+}
+
+void frame_parser::commit(std::size_t size) {
+	this->write_position += size;
+}
+
+frame_parser::result frame_parser::parse(frame& parsed_frame) {
+	for (;;) {
+		if (this->extended_frame_size != 0) {
+			return this->parse_extended_frame(parsed_frame);
+		}
+
+		this->synchronise();
+
+		const std::size_t available_size = this->write_position - this->read_position;
+
+		if (available_size < header_size) {
+			return result::incomplete;
+		}
+
+		const std::size_t frame_size = this->get_byte(lng_offset);
+
+		if (frame_size == extended_lng) {
+			if (available_size < header_size + 1) {
+				return result::incomplete;
+			}
+
+			const std::size_t length_offset = this->get_extended_length_offset();
+			if (available_size < length_offset + extended_length_size) {
+				return result::incomplete;
+			}
+
+			const std::size_t extended_size = ((std::size_t)this->get_byte(length_offset) << 8) | this->get_byte(length_offset + 1);
+			if (extended_size < length_offset + extended_length_size + sizeof(std::uint16_t)) {
+				// the sync byte does not start a frame
+				this->lose_synchronisation();
+				this->skip(1);
+				continue;
+			}
+
+			this->extended_frame_size = extended_size;
+			this->extended_bytes.clear();
+			continue;
+		}
+
+		if (frame_size < frame_size_min) {
+			// the sync byte does not start a frame
+			this->lose_synchronisation();
+			this->skip(1);
+			continue;
+		}
+
+		if (available_size < frame_size) {
+			return result::incomplete;
+		}
+
+		// copy the frame, it may wrap around the end of the buffer
+		const std::size_t offset = this->read_position % buffer_capacity;
+		const std::size_t first_part_size = std::min(frame_size, buffer_capacity - offset);
+		parsed_frame.clear();
+		parsed_frame.append(this->buffer.data() + offset, first_part_size);
+		parsed_frame.append(this->buffer.data(), frame_size - first_part_size);
+
+		const std::uint16_t crc = crc16_engine::compute(parsed_frame.data(), frame_size - sizeof(std::uint16_t));
+
+		if (crc != (((std::uint16_t)(parsed_frame[frame_size - 1] << 8)) | parsed_frame[frame_size - 2])) {
+			// the frame may have started on a later sync byte
+			this->lose_synchronisation();
+			this->skip(1);
+			return result::crc_error;
+		}
+
+		this->skip(frame_size);
+		this->is_synchronised = true;
+		return result::frame_received;
+	}
+}
+
+const extended_frame& frame_parser::get_extended_frame() const {
+	return this->extended_bytes;
+}
+
+bool frame_parser::is_receiving() const {
+	return (this->read_position != this->write_position) || (this->extended_frame_size != 0);
+}
+
+bool frame_parser::is_receiving_extended_frame() const {
+	return this->extended_frame_size != 0;
+}
+
+std::size_t frame_parser::get_missing_size() const {
+	const std::size_t available_size = this->write_position - this->read_position;
+
+	if (this->extended_frame_size != 0) {
+		const std::size_t missing_size = this->extended_frame_size - this->extended_bytes.size();
+		return (missing_size > available_size) ? (missing_size - available_size) : 0;
+	}
+
+	if (available_size < header_size) {
+		return header_size - available_size;
+	}
+
+	std::size_t frame_size = this->get_byte(lng_offset);
+
+	if (frame_size == extended_lng) {
+		// the length of the extended frame is still to be received
+		if (available_size < header_size + 1) {
+			return header_size + 1 - available_size;
+		}
+
+		const std::size_t length_offset = this->get_extended_length_offset();
+		if (available_size < length_offset + extended_length_size) {
+			return length_offset + extended_length_size - available_size;
+		}
+
+		frame_size = ((std::size_t)this->get_byte(length_offset) << 8) | this->get_byte(length_offset + 1);
+	}
+
+	return (frame_size > available_size) ? (frame_size - available_size) : 0;
+}
+
+void frame_parser::resynchronise() {
+	if (this->extended_frame_size != 0) {
+		// the received part of the extended frame is gone
+		this->extended_frame_size = 0;
+		this->lose_synchronisation();
+	} else if (this->is_receiving()) {
+		this->lose_synchronisation();
+		this->skip(1);
+	}
+}
+
+void frame_parser::reset() {
+	this->read_position = this->write_position;
+	this->is_synchronised = true;
+	this->extended_frame_size = 0;
+}
+
+std::uint64_t frame_parser::get_sync_losses_count() const {
+	return this->sync_losses_count;
+}
+
+frame_parser::result frame_parser::parse_extended_frame(frame& parsed_frame) {
+	const std::size_t available_size = this->write_position - this->read_position;
+	const std::size_t copied_size = std::min(available_size, this->extended_frame_size - this->extended_bytes.size());
+
+	// copy the bytes, they may wrap around the end of the buffer
+	const std::size_t offset = this->read_position % buffer_capacity;
+	const std::size_t first_part_size = std::min(copied_size, buffer_capacity - offset);
+	this->extended_bytes.insert(this->extended_bytes.end(), this->buffer.data() + offset, this->buffer.data() + offset + first_part_size);
+	this->extended_bytes.insert(this->extended_bytes.end(), this->buffer.data(), this->buffer.data() + copied_size - first_part_size);
+	this->skip(copied_size);
+
+	if (this->extended_bytes.size() < this->extended_frame_size) {
+		return result::incomplete;
+	}
+
+	this->extended_frame_size = 0;
+	parsed_frame.clear();
+	parsed_frame.append(this->extended_bytes.data(), header_size);
+
+	const std::size_t frame_size = this->extended_bytes.size();
+	const std::uint16_t crc = crc16_engine::compute(this->extended_bytes.data(), frame_size - sizeof(std::uint16_t));
+
+	if (crc != (((std::uint16_t)(this->extended_bytes[frame_size - 1] << 8)) | this->extended_bytes[frame_size - 2])) {
+		// the bytes have left the ring buffer, the next frame starts after them
+		this->lose_synchronisation();
+		return result::crc_error;
+	}
+
+	this->is_synchronised = true;
+	return result::extended_frame_received;
+}
+
+std::size_t frame_parser::get_extended_length_offset() const {
+	if (this->sender == frame_sender::device) {
+		return header_size;
+	}
+
+	return header_size + 1 + ((this->get_byte(header_size) == subcommand_command) ? 1 : 0);
+}
+
+std::uint8_t frame_parser::get_byte(std::size_t offset) const {
+	return this->buffer[(this->read_position + offset) % buffer_capacity];
+}
+
+void frame_parser::skip(std::size_t size) {
+	this->read_position += size;
+}
+
+void frame_parser::synchronise() {
+	while ((this->read_position != this->write_position) && (this->get_byte(sync_offset) != sync)) {
+		this->lose_synchronisation();
+		++this->read_position;
+	}
+}
+
+void frame_parser::lose_synchronisation() {
+	if (this->is_synchronised) {
+		this->is_synchronised = false;
+		++this->sync_losses_count;
+	}
+}
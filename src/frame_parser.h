@@ -0,0 +1,94 @@
+#ifndef CCNET_FRAME_PARSER_H
+#define CCNET_FRAME_PARSER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "frame.h"
+
+namespace ccnet {
+
+	// extracts frames from the bytes received on the line;
+	// the bytes are kept in a ring buffer filled by bulk reads,
+	// the bytes preceding a sync byte are skipped and a frame with an invalid length
+	// or frame check sequence only costs a resynchronisation on the next sync byte;
+	// an extended frame is moved out of the ring buffer as it arrives,
+	// so a corrupted one is dropped as a whole
+	class frame_parser {
+		public:
+			enum class result {
+				incomplete,
+				frame_received,
+				extended_frame_received,
+				crc_error
+			};
+
+			// the length of an extended frame follows the header in a device frame
+			// and the command and the subcommand in a controller frame
+			enum class frame_sender {
+				device,
+				controller
+			};
+
+			explicit frame_parser(frame_sender sender = frame_sender::device);
+
+			frame_parser(const frame_parser& other) = delete;
+
+			frame_parser& operator=(const frame_parser& other) = delete;
+
+			// the contiguous free space the received bytes may be written to
+			std::uint8_t* get_write_position();
+			std::size_t get_write_size() const;
+			// makes the bytes written to the free space available to the parser
+			void commit(std::size_t size);
+
+			// extracts the next complete frame with a valid frame check sequence,
+			// the frame failing the check is returned along with crc_error,
+			// only the header of an extended one
+			result parse(frame& parsed_frame);
+			// the frame extracted along with extended_frame_received
+			const extended_frame& get_extended_frame() const;
+			// tells whether the beginning of a frame has been received
+			bool is_receiving() const;
+			bool is_receiving_extended_frame() const;
+			// the number of bytes the frame being received still lacks
+			std::size_t get_missing_size() const;
+			// gives up the frame being received and looks for the next sync byte
+			void resynchronise();
+			// drops the buffered bytes
+			void reset();
+			// the number of times the bytes were discarded between two valid frames
+			std::uint64_t get_sync_losses_count() const;
+
+		private:
+			// moves the received bytes of the extended frame out of the ring buffer
+			result parse_extended_frame(frame& parsed_frame);
+			// the offset of the length of the extended frame at the read position,
+			// the command byte has to be available
+			std::size_t get_extended_length_offset() const;
+			std::uint8_t get_byte(std::size_t offset) const;
+			void skip(std::size_t size);
+			// drops the bytes up to the next sync byte
+			void synchronise();
+			void lose_synchronisation();
+
+		private:
+			// holds the longest frame with room for the following bytes
+			static const std::size_t buffer_capacity = 512;
+
+			const frame_sender sender;
+			std::array<std::uint8_t, buffer_capacity> buffer;
+			// the positions grow monotonically and wrap around the buffer
+			std::size_t read_position;
+			std::size_t write_position;
+			// false after the bytes have been discarded, until the next valid frame
+			bool is_synchronised;
+			std::uint64_t sync_losses_count;
+			// the size of the extended frame being received, 0 if none
+			std::size_t extended_frame_size;
+			extended_frame extended_bytes;
+	};
+
+}
+
+#endif // CCNET_FRAME_PARSER_H
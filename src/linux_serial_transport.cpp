@@ -0,0 +1,234 @@
+#include "linux_serial_transport.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace boost::asio;
+using namespace ccnet;
+
+void throw_system_error(int error_code) {
+	throw boost::system::system_error(error_code, boost::system::system_category());
+}
+
+speed_t get_speed(std::uint32_t baud_rate) {
+	switch (baud_rate) {
+		case 1200: return B1200;
+		case 2400: return B2400;
+		case 4800: return B4800;
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+		case 460800: return B460800;
+		case 921600: return B921600;
+		default: throw boost::system::system_error(error::operation_not_supported);
+	}
+}
+
+tcflag_t get_character_size_flag(std::uint8_t character_size) {
+	switch (character_size) {
+		case 5: return CS5;
+		case 6: return CS6;
+		case 7: return CS7;
+		case 8: return CS8;
+		default: throw boost::system::system_error(error::operation_not_supported);
+	}
+}
+
+linux_serial_transport::linux_serial_transport(const std::string& port_name) :
+	descriptor(-1),
+	epoll_descriptor(-1),
+	registered_events(EPOLLIN) {
+	// the descriptor never blocks, the calling thread waits in epoll_wait
+	this->descriptor = ::open(port_name.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (this->descriptor < 0) {
+		throw_system_error(errno);
+	}
+
+	this->epoll_descriptor = ::epoll_create1(EPOLL_CLOEXEC);
+	epoll_event event = {};
+	event.events = this->registered_events;
+	event.data.fd = this->descriptor;
+
+	if ((this->epoll_descriptor < 0) || (::epoll_ctl(this->epoll_descriptor, EPOLL_CTL_ADD, this->descriptor, &event) != 0)) {
+		const int error_code = errno;
+		this->close();
+		throw_system_error(error_code);
+	}
+
+	// USB bridges hold the received bytes for up to 16 ms by default;
+	// not every driver supports the flag, the line works without it anyway
+	serial_struct serial_info;
+	if (::ioctl(this->descriptor, TIOCGSERIAL, &serial_info) == 0) {
+		serial_info.flags |= ASYNC_LOW_LATENCY;
+		::ioctl(this->descriptor, TIOCSSERIAL, &serial_info);
+	}
+}
+
+linux_serial_transport::~linux_serial_transport() {
+	this->close();
+}
+
+void linux_serial_transport::set_options(const connection_options& options) {
+	if (options.stop_bits == connection_options::stop_bits_type::one_point_five) {
+		throw boost::system::system_error(error::operation_not_supported);
+	}
+
+	termios attributes;
+	if (::tcgetattr(this->descriptor, &attributes) != 0) {
+		throw_system_error(errno);
+	}
+
+	::cfmakeraw(&attributes);
+	attributes.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB | CRTSCTS);
+	attributes.c_cflag |= CLOCAL | CREAD | get_character_size_flag(options.character_size);
+
+	if (options.parity != connection_options::parity_type::none) {
+		attributes.c_cflag |= PARENB;
+		attributes.c_iflag |= INPCK;
+
+		if (options.parity == connection_options::parity_type::odd) {
+			attributes.c_cflag |= PARODD;
+		}
+	}
+
+	if (options.stop_bits == connection_options::stop_bits_type::two) {
+		attributes.c_cflag |= CSTOPB;
+	}
+
+	// a read returns the bytes received so far without waiting for more,
+	// the arrival of the first byte is signalled by epoll
+	attributes.c_cc[VMIN] = 0;
+	attributes.c_cc[VTIME] = 0;
+
+	const speed_t speed = get_speed(options.baud_rate);
+	::cfsetispeed(&attributes, speed);
+	::cfsetospeed(&attributes, speed);
+
+	if (::tcsetattr(this->descriptor, TCSANOW, &attributes) != 0) {
+		throw_system_error(errno);
+	}
+}
+
+void linux_serial_transport::set_baud_rate(std::uint32_t baud_rate) {
+	termios attributes;
+	if (::tcgetattr(this->descriptor, &attributes) != 0) {
+		throw_system_error(errno);
+	}
+
+	const speed_t speed = get_speed(baud_rate);
+	::cfsetispeed(&attributes, speed);
+	::cfsetospeed(&attributes, speed);
+
+	if (::tcsetattr(this->descriptor, TCSANOW, &attributes) != 0) {
+		throw_system_error(errno);
+	}
+}
+
+bool linux_serial_transport::write(const const_buffer& data, clock::duration timeout) {
+	const clock::time_point deadline = clock::now() + timeout;
+	const std::uint8_t* position = (const std::uint8_t*)data.data();
+	std::size_t remaining_size = data.size();
+
+	while (remaining_size > 0) {
+		const ssize_t written_size = ::write(this->descriptor, position, remaining_size);
+
+		if (written_size > 0) {
+			position += written_size;
+			remaining_size -= (std::size_t)written_size;
+			continue;
+		}
+
+		if ((written_size < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+			throw_system_error(errno);
+		}
+
+		if (!this->wait(EPOLLOUT, deadline)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::size_t linux_serial_transport::read_some(const mutable_buffer& data, clock::duration timeout) {
+	const clock::time_point deadline = clock::now() + timeout;
+
+	for (;;) {
+		const ssize_t read_size = ::read(this->descriptor, data.data(), data.size());
+
+		if (read_size > 0) {
+			return (std::size_t)read_size;
+		}
+
+		if ((read_size < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+			throw_system_error(errno);
+		}
+
+		if (!this->wait(EPOLLIN, deadline)) {
+			return 0;
+		}
+	}
+}
+
+void linux_serial_transport::discard_input() {
+	::tcflush(this->descriptor, TCIFLUSH);
+}
+
+bool linux_serial_transport::wait(std::uint32_t events, clock::time_point deadline) {
+	if (events != this->registered_events) {
+		epoll_event event = {};
+		event.events = events;
+		event.data.fd = this->descriptor;
+
+		if (::epoll_ctl(this->epoll_descriptor, EPOLL_CTL_MOD, this->descriptor, &event) != 0) {
+			throw_system_error(errno);
+		}
+
+		this->registered_events = events;
+	}
+
+	for (;;) {
+		const clock::time_point now = clock::now();
+
+		if (now >= deadline) {
+			return false;
+		}
+
+		// rounded up not to wake up before the deadline
+		const std::int64_t timeout = (std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count() + 999) / 1000;
+		epoll_event event;
+		const int ready_count = ::epoll_wait(this->epoll_descriptor, &event, 1, (int)timeout);
+
+		if ((ready_count < 0) && (errno != EINTR)) {
+			throw_system_error(errno);
+		}
+
+		if (ready_count > 0) {
+			if ((event.events & (EPOLLERR | EPOLLHUP)) != 0) {
+				// the device has been unplugged
+				throw_system_error(EIO);
+			}
+
+			return true;
+		}
+	}
+}
+
+void linux_serial_transport::close() {
+	if (this->epoll_descriptor >= 0) {
+		::close(this->epoll_descriptor);
+		this->epoll_descriptor = -1;
+	}
+
+	if (this->descriptor >= 0) {
+		::close(this->descriptor);
+		this->descriptor = -1;
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef CCNET_LINUX_SERIAL_TRANSPORT_H
+#define CCNET_LINUX_SERIAL_TRANSPORT_H
+
+#include <cstdint>
+#include <string>
+#include "serial_transport.h"
+
+namespace ccnet {
+
+	// the low latency transport driving the tty directly from the calling thread:
+	// the driver is asked to deliver the received bytes at once (ASYNC_LOW_LATENCY)
+	// and the calling thread waits for them with epoll instead of handing the operation to the I/O thread
+	class linux_serial_transport : public serial_transport {
+		public:
+			explicit linux_serial_transport(const std::string& port_name);
+
+			linux_serial_transport(const linux_serial_transport& other) = delete;
+
+			~linux_serial_transport();
+
+			linux_serial_transport& operator=(const linux_serial_transport& other) = delete;
+
+			void set_options(const connection_options& options) override;
+			void set_baud_rate(std::uint32_t baud_rate) override;
+
+			bool write(const boost::asio::const_buffer& data, clock::duration timeout) override;
+			std::size_t read_some(const boost::asio::mutable_buffer& data, clock::duration timeout) override;
+			void discard_input() override;
+
+		private:
+			// waits for the descriptor to become ready for the events,
+			// returns false if the deadline expired first
+			bool wait(std::uint32_t events, clock::time_point deadline);
+			void close();
+
+		private:
+			int descriptor;
+			int epoll_descriptor;
+			// the events the descriptor is registered for
+			std::uint32_t registered_events;
+	};
+
+}
+
+#endif // CCNET_LINUX_SERIAL_TRANSPORT_H
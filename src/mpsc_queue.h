@@ -0,0 +1,108 @@
+#ifndef CCNET_MPSC_QUEUE_H
+#define CCNET_MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace ccnet {
+
+	// bounded lock-free queue for many producers and a single consumer;
+	// every cell carries a sequence number telling whether it may be written or read
+	template<typename T>
+	class mpsc_queue {
+		public:
+			// the capacity has to be a power of two
+			explicit mpsc_queue(std::size_t capacity) :
+				cells(new cell[capacity]),
+				index_mask(capacity - 1),
+				enqueue_position_padding(),
+				enqueue_position(0),
+				dequeue_position_padding(),
+				dequeue_position(0) {
+				if ((capacity < 2) || ((capacity & (capacity - 1)) != 0)) {
+					throw std::runtime_error("invalid arguments");
+				}
+
+				for (std::size_t i = 0; i < capacity; ++i) {
+					this->cells[i].sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			mpsc_queue(const mpsc_queue& other) = delete;
+
+			mpsc_queue& operator=(const mpsc_queue& other) = delete;
+
+			// returns false if the queue is full
+			bool try_push(T&& value) {
+				std::size_t position = this->enqueue_position.load(std::memory_order_relaxed);
+
+				for (;;) {
+					cell& current_cell = this->cells[position & this->index_mask];
+					const std::size_t sequence = current_cell.sequence.load(std::memory_order_acquire);
+					const std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+
+					if (difference == 0) {
+						// the cell is free, try to claim it
+						if (this->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+							current_cell.value = std::move(value);
+							current_cell.sequence.store(position + 1, std::memory_order_release);
+							return true;
+						}
+					} else if (difference < 0) {
+						// the cell has not been consumed yet
+						return false;
+					} else {
+						// another producer has claimed the cell
+						position = this->enqueue_position.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			// returns false if the queue is empty;
+			// must be called from the consumer thread only
+			bool try_pop(T& value) {
+				const std::size_t position = this->dequeue_position.load(std::memory_order_relaxed);
+				cell& current_cell = this->cells[position & this->index_mask];
+
+				if (current_cell.sequence.load(std::memory_order_acquire) != position + 1) {
+					return false;
+				}
+
+				value = std::move(current_cell.value);
+				this->dequeue_position.store(position + 1, std::memory_order_relaxed);
+				// make the cell available for the next round of producers
+				current_cell.sequence.store(position + this->index_mask + 1, std::memory_order_release);
+				return true;
+			}
+
+			// tells whether the next value is ready to be popped
+			bool is_empty() const {
+				const std::size_t position = this->dequeue_position.load(std::memory_order_relaxed);
+
+				return this->cells[position & this->index_mask].sequence.load(std::memory_order_acquire) != position + 1;
+			}
+
+		private:
+			static const std::size_t cache_line_size = 64;
+
+			struct cell {
+				std::atomic<std::size_t> sequence;
+				T value;
+			};
+
+		private:
+			std::unique_ptr<cell[]> cells;
+			const std::size_t index_mask;
+			// producers and the consumer update different cache lines
+			char enqueue_position_padding[cache_line_size];
+			std::atomic<std::size_t> enqueue_position;
+			char dequeue_position_padding[cache_line_size - sizeof(std::atomic<std::size_t>)];
+			std::atomic<std::size_t> dequeue_position;
+	};
+
+}
+
+#endif // CCNET_MPSC_QUEUE_H
@@ -0,0 +1,41 @@
+#include "poll_policy.h"
+
+using namespace ccnet;
+
+std::chrono::milliseconds poll_policy::get_interval(device_state_code state_code) const {
+	if (!this->state_intervals.empty()) {
+		std::map<device_state_code, std::chrono::milliseconds>::const_iterator iter = this->state_intervals.find(state_code);
+
+		if (iter != this->state_intervals.cend()) {
+			return iter->second;
+		}
+	}
+
+	switch (state_code) {
+		case device_state_code::accepting:
+		case device_state_code::stacking:
+		case device_state_code::returning:
+		case device_state_code::rejecting:
+		case device_state_code::escrow_pos:
+		case device_state_code::bill_stacked:
+		case device_state_code::bill_returned: {
+			return this->active_interval;
+		}
+		case device_state_code::idling:
+		case device_state_code::unit_disabled:
+		case device_state_code::pause: {
+			return this->idle_interval;
+		}
+		case device_state_code::drop_cassette_full:
+		case device_state_code::drop_cassette_out_of_pos:
+		case device_state_code::validator_jammed:
+		case device_state_code::drop_cassette_jammed:
+		case device_state_code::cheated:
+		case device_state_code::failure: {
+			return this->watchdog_interval;
+		}
+		default: {
+			return this->default_interval;
+		}
+	}
+}
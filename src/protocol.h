@@ -0,0 +1,34 @@
+#ifndef CCNET_PROTOCOL_H
+#define CCNET_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ccnet {
+
+	// acknowledge
+	const std::uint8_t ack = 0x00;
+	// negative acknowledge
+	const std::uint8_t nak = 0xff;
+	// illegal command
+	const std::uint8_t ill_cmd = 0x30;
+
+	const std::uint8_t sync = 0x02;
+
+	// frame header structure
+	const std::uint8_t header_size = 3; // in bytes
+	const std::uint8_t sync_offset = 0;
+	const std::uint8_t adr_offset = 1;
+	const std::uint8_t lng_offset = 2;
+
+	// a frame too long for LNG has LNG set to 0 and carries its length in the two bytes
+	// following the header, or the command and the subcommand of a controller frame, MSB first
+	const std::uint8_t extended_lng = 0x00;
+	const std::uint8_t extended_length_size = 2; // in bytes
+	const std::size_t extended_frame_size_max = 0xffff;
+	// the command followed by a subcommand, the only one the controller sends in extended frames
+	const std::uint8_t subcommand_command = 0x50;
+
+}
+
+#endif // CCNET_PROTOCOL_H
@@ -0,0 +1,66 @@
+#include "request_pool.h"
+#include <stdexcept>
+
+using namespace ccnet;
+
+const std::uint32_t no_block = 0xFFFFFFFF;
+const std::size_t block_alignment = alignof(std::max_align_t);
+
+std::uint64_t make_free_blocks_head(std::uint64_t previous_head, std::uint32_t block_index) {
+	// increment the tag on every modification
+	return ((previous_head & 0xFFFFFFFF00000000) + 0x100000000) | block_index;
+}
+
+block_pool::block_pool(std::size_t block_size, std::size_t blocks_count) :
+	block_size((block_size + block_alignment - 1) / block_alignment * block_alignment),
+	blocks_count(blocks_count),
+	storage(new unsigned char[this->block_size * blocks_count]),
+	next_free_blocks(new std::atomic<std::uint32_t>[blocks_count]),
+	free_blocks_head(0) {
+	if ((blocks_count == 0) || (blocks_count >= no_block)) {
+		throw std::runtime_error("invalid arguments");
+	}
+
+	for (std::uint32_t block_index = 0; block_index < blocks_count; ++block_index) {
+		this->next_free_blocks[block_index].store((block_index + 1 < blocks_count) ? block_index + 1 : no_block, std::memory_order_relaxed);
+	}
+}
+
+void* block_pool::allocate(std::size_t size) {
+	if (size > this->block_size) {
+		return nullptr;
+	}
+
+	std::uint64_t head = this->free_blocks_head.load(std::memory_order_acquire);
+
+	for (;;) {
+		const std::uint32_t block_index = (std::uint32_t)(head & 0xFFFFFFFF);
+
+		if (block_index == no_block) {
+			return nullptr;
+		}
+
+		const std::uint32_t next_block_index = this->next_free_blocks[block_index].load(std::memory_order_relaxed);
+
+		if (this->free_blocks_head.compare_exchange_weak(head, make_free_blocks_head(head, next_block_index), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			return this->storage.get() + block_index * this->block_size;
+		}
+	}
+}
+
+bool block_pool::deallocate(void* block) {
+	unsigned char* const block_address = static_cast<unsigned char*>(block);
+
+	if ((block_address < this->storage.get()) || (block_address >= this->storage.get() + this->block_size * this->blocks_count)) {
+		return false;
+	}
+
+	const std::uint32_t block_index = (std::uint32_t)((block_address - this->storage.get()) / this->block_size);
+	std::uint64_t head = this->free_blocks_head.load(std::memory_order_relaxed);
+
+	do {
+		this->next_free_blocks[block_index].store((std::uint32_t)(head & 0xFFFFFFFF), std::memory_order_relaxed);
+	} while (!this->free_blocks_head.compare_exchange_weak(head, make_free_blocks_head(head, block_index), std::memory_order_release, std::memory_order_relaxed));
+
+	return true;
+}
@@ -0,0 +1,151 @@
+#ifndef CCNET_REQUEST_POOL_H
+#define CCNET_REQUEST_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "host_request.h"
+
+namespace ccnet {
+
+	// preallocated fixed-size memory blocks;
+	// the free blocks form a lock-free stack, so blocks may be taken and returned from any thread
+	class block_pool {
+		public:
+			block_pool(std::size_t block_size, std::size_t blocks_count);
+
+			block_pool(const block_pool& other) = delete;
+
+			block_pool& operator=(const block_pool& other) = delete;
+
+			// returns nullptr if the size exceeds the block size or no free blocks are left
+			void* allocate(std::size_t size);
+			// returns false if the memory does not belong to the pool
+			bool deallocate(void* block);
+
+		private:
+			const std::size_t block_size;
+			const std::size_t blocks_count;
+			std::unique_ptr<unsigned char[]> storage;
+			std::unique_ptr<std::atomic<std::uint32_t>[]> next_free_blocks;
+			// the index of the first free block and a modification tag against ABA
+			std::atomic<std::uint64_t> free_blocks_head;
+	};
+
+	// allocates from the pool and falls back to the heap when the pool cannot serve the request;
+	// the pool lives as long as any memory allocated from it (e.g. a future shared state)
+	template<typename T>
+	class pool_allocator {
+		public:
+			typedef T value_type;
+
+			explicit pool_allocator(const std::shared_ptr<block_pool>& pool) :
+				pool(pool) { }
+
+			template<typename U>
+			pool_allocator(const pool_allocator<U>& other) :
+				pool(other.pool) { }
+
+			T* allocate(std::size_t count) {
+				void* memory = this->pool->allocate(count * sizeof(T));
+
+				if (memory == nullptr) {
+					memory = ::operator new(count * sizeof(T));
+				}
+
+				return static_cast<T*>(memory);
+			}
+
+			void deallocate(T* memory, std::size_t) {
+				if (!this->pool->deallocate(memory)) {
+					::operator delete(memory);
+				}
+			}
+
+			std::shared_ptr<block_pool> pool;
+	};
+
+	template<typename T, typename U>
+	bool operator==(const pool_allocator<T>& lhs, const pool_allocator<U>& rhs) {
+		return lhs.pool == rhs.pool;
+	}
+
+	template<typename T, typename U>
+	bool operator!=(const pool_allocator<T>& lhs, const pool_allocator<U>& rhs) {
+		return !(lhs == rhs);
+	}
+
+	// binds a pool allocator to a handler,
+	// so the memory of the asynchronous operation wrapping it is not taken from the heap
+	template<typename Handler>
+	class pooled_handler {
+		public:
+			typedef pool_allocator<void> allocator_type;
+
+			pooled_handler(Handler handler, const allocator_type& allocator) :
+				handler(std::move(handler)),
+				allocator(allocator) { }
+
+			allocator_type get_allocator() const noexcept {
+				return this->allocator;
+			}
+
+			template<typename... Args>
+			void operator()(Args&&... args) {
+				this->handler(std::forward<Args>(args)...);
+			}
+
+		private:
+			Handler handler;
+			allocator_type allocator;
+	};
+
+	template<typename Handler>
+	pooled_handler<typename std::decay<Handler>::type> make_pooled_handler(Handler&& handler, const std::shared_ptr<block_pool>& pool) {
+		return pooled_handler<typename std::decay<Handler>::type>(std::forward<Handler>(handler), pool_allocator<void>(pool));
+	}
+
+	// a request completed through a promise allocated from the pool
+	template<typename T>
+	class promise_request : public typed_request<T> {
+		public:
+			explicit promise_request(const std::shared_ptr<block_pool>& pool) :
+				promise(std::allocator_arg, pool_allocator<T>(pool)) { }
+
+			void set_value(T value) override {
+				this->promise.set_value(std::move(value));
+			}
+
+			void fail(std::exception_ptr error) override {
+				this->promise.set_exception(error);
+			}
+
+			std::promise<T> promise;
+	};
+
+	template<>
+	class promise_request<void> : public typed_request<void> {
+		public:
+			explicit promise_request(const std::shared_ptr<block_pool>& pool) :
+				promise(std::allocator_arg, pool_allocator<void>(pool)) { }
+
+			void set_value() override {
+				this->promise.set_value();
+			}
+
+			void fail(std::exception_ptr error) override {
+				this->promise.set_exception(error);
+			}
+
+			std::promise<void> promise;
+	};
+
+}
+
+#endif // CCNET_REQUEST_POOL_H
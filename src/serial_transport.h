@@ -0,0 +1,37 @@
+#ifndef CCNET_SERIAL_TRANSPORT_H
+#define CCNET_SERIAL_TRANSPORT_H
+
+#include <chrono>
+#include <cstdint>
+#include <boost/asio.hpp>
+#include "connection_options.h"
+
+namespace ccnet {
+
+	// serial line access with a deadline for every read and write;
+	// the calling thread waits for the completion or the deadline
+	class serial_transport {
+		public:
+			typedef std::chrono::steady_clock clock;
+
+			virtual ~serial_transport() = default;
+
+			// applies the framing and the baud rate of the options
+			virtual void set_options(const connection_options& options) = 0;
+			virtual void set_baud_rate(std::uint32_t baud_rate) = 0;
+
+			// writes the whole buffer,
+			// returns false if the deadline expired before the data was sent
+			virtual bool write(const boost::asio::const_buffer& data, clock::duration timeout) = 0;
+
+			// reads the bytes available on the line, at most the size of the buffer,
+			// returns 0 if the deadline expired before any data was received
+			virtual std::size_t read_some(const boost::asio::mutable_buffer& data, clock::duration timeout) = 0;
+
+			// discards the data received but not read yet
+			virtual void discard_input() = 0;
+	};
+
+}
+
+#endif // CCNET_SERIAL_TRANSPORT_H
@@ -0,0 +1,87 @@
+#ifndef CCNET_STATE_MACHINE_H
+#define CCNET_STATE_MACHINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "ccnet.h"
+
+namespace ccnet {
+
+	// dispatches the changes of the device state code to the handlers of the context:
+	// the exit hook of the previous state, the action bound to the pair of the states
+	// and the entry hook of the current state run in this order,
+	// a handler returning false skips the following ones;
+	// the hooks are indexed by the state code and the actions are searched among a few transitions,
+	// so the dispatch takes a bounded time and touches nothing but the handlers of the context
+	template<typename Context>
+	class state_machine {
+		public:
+			typedef bool (Context::*handler)();
+
+			struct state_hooks {
+				device_state_code code;
+				handler on_entry;
+				handler on_exit;
+			};
+
+			struct transition {
+				device_state_code previous;
+				device_state_code current;
+				handler action;
+			};
+
+			// the tables are referenced, not copied, so they have to outlive the state machine
+			template<std::size_t HooksCount, std::size_t TransitionsCount>
+			constexpr state_machine(const state_hooks (&hooks)[HooksCount], const transition (&transitions)[TransitionsCount]) :
+				hooks(hooks),
+				hook_numbers(),
+				transitions(transitions),
+				transitions_count(TransitionsCount) {
+				static_assert(HooksCount < state_codes_count, "too many state hooks");
+
+				for (std::size_t i = 0; i < HooksCount; ++i) {
+					this->hook_numbers[(std::uint8_t)hooks[i].code] = (std::uint8_t)(i + 1);
+				}
+			}
+
+			// returns false if a handler has ended the dispatch
+			bool dispatch(Context& context, device_state_code previous, device_state_code current) const {
+				const handler on_exit = this->find_hooks(previous).on_exit;
+				if ((on_exit != nullptr) && (!(context.*on_exit)())) {
+					return false;
+				}
+
+				for (std::size_t i = 0; i < this->transitions_count; ++i) {
+					if ((this->transitions[i].previous == previous) && (this->transitions[i].current == current)) {
+						if (!(context.*(this->transitions[i].action))()) {
+							return false;
+						}
+						break;
+					}
+				}
+
+				const handler on_entry = this->find_hooks(current).on_entry;
+				return (on_entry == nullptr) || (context.*on_entry)();
+			}
+
+		private:
+			static const std::size_t state_codes_count = 256;
+
+			const state_hooks& find_hooks(device_state_code code) const {
+				static const state_hooks no_hooks = { device_state_code::unknown, nullptr, nullptr };
+
+				const std::uint8_t hook_number = this->hook_numbers[(std::uint8_t)code];
+				return (hook_number == 0) ? no_hooks : this->hooks[hook_number - 1];
+			}
+
+		private:
+			const state_hooks* hooks;
+			// the numbers of the hooks by the state codes starting from 1, 0 for the states without hooks
+			std::uint8_t hook_numbers[state_codes_count];
+			const transition* transitions;
+			std::size_t transitions_count;
+	};
+
+}
+
+#endif // CCNET_STATE_MACHINE_H
@@ -0,0 +1,93 @@
+#include "statistics_recorder.h"
+
+using namespace ccnet;
+
+// the index of the highest bit set, the latencies below 2 microseconds fall into the first bucket
+std::size_t get_bucket_index(std::uint64_t latency) {
+	std::size_t index = 0;
+
+	while ((latency >>= 1) != 0) {
+		++index;
+	}
+
+	return (index < latency_histogram::buckets_count) ? index : latency_histogram::buckets_count - 1;
+}
+
+statistics_recorder::latency_counters::latency_counters() :
+	buckets(),
+	count(0),
+	total_latency(0) {
+	for (std::size_t i = 0; i < this->buckets.size(); ++i) {
+		this->buckets[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+statistics_recorder::statistics_recorder() :
+	counters(),
+	latencies(),
+	exchange_latencies() {
+	for (std::size_t i = 0; i < this->counters.size(); ++i) {
+		this->counters[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void statistics_recorder::increment(counter counter_id, std::uint64_t value) {
+	this->counters[(std::size_t)counter_id].fetch_add(value, std::memory_order_relaxed);
+}
+
+void statistics_recorder::record_latency(std::uint8_t command_code, std::chrono::microseconds latency) {
+	if ((command_code < command_code_min) || (command_code > command_code_max)) {
+		return;
+	}
+
+	record(this->latencies[command_code - command_code_min], latency);
+}
+
+void statistics_recorder::record_exchange_latency(std::chrono::microseconds latency) {
+	record(this->exchange_latencies, latency);
+}
+
+device_statistics statistics_recorder::get_snapshot() const {
+	device_statistics snapshot;
+
+	snapshot.commands_count = this->counters[(std::size_t)counter::commands].load(std::memory_order_relaxed);
+	snapshot.acks_count = this->counters[(std::size_t)counter::acks].load(std::memory_order_relaxed);
+	snapshot.naks_count = this->counters[(std::size_t)counter::naks].load(std::memory_order_relaxed);
+	snapshot.illegal_commands_count = this->counters[(std::size_t)counter::illegal_commands].load(std::memory_order_relaxed);
+	snapshot.timeouts_count = this->counters[(std::size_t)counter::timeouts].load(std::memory_order_relaxed);
+	snapshot.crc_errors_count = this->counters[(std::size_t)counter::crc_errors].load(std::memory_order_relaxed);
+	snapshot.sync_losses_count = this->counters[(std::size_t)counter::sync_losses].load(std::memory_order_relaxed);
+	snapshot.retries_count = this->counters[(std::size_t)counter::retries].load(std::memory_order_relaxed);
+	snapshot.journal_errors_count = this->counters[(std::size_t)counter::journal_errors].load(std::memory_order_relaxed);
+
+	for (std::size_t i = 0; i < this->latencies.size(); ++i) {
+		if (this->latencies[i].count.load(std::memory_order_relaxed) != 0) {
+			snapshot.command_latencies.emplace((std::uint8_t)(command_code_min + i), read(this->latencies[i]));
+		}
+	}
+
+	snapshot.exchange_latencies = read(this->exchange_latencies);
+
+	return snapshot;
+}
+
+void statistics_recorder::record(latency_counters& entry, std::chrono::microseconds latency) {
+	const std::uint64_t latency_value = (latency.count() > 0) ? (std::uint64_t)latency.count() : 0;
+
+	entry.buckets[get_bucket_index(latency_value)].fetch_add(1, std::memory_order_relaxed);
+	entry.total_latency.fetch_add(latency_value, std::memory_order_relaxed);
+	entry.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+latency_histogram statistics_recorder::read(const latency_counters& entry) {
+	// the buckets are summed up instead of reading the count
+	// to keep the histogram consistent with a concurrent update
+	latency_histogram histogram;
+	for (std::size_t i = 0; i < histogram.buckets.size(); ++i) {
+		histogram.buckets[i] = entry.buckets[i].load(std::memory_order_relaxed);
+		histogram.count += histogram.buckets[i];
+	}
+	histogram.total_latency = std::chrono::microseconds(entry.total_latency.load(std::memory_order_relaxed));
+
+	return histogram;
+}
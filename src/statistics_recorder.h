@@ -0,0 +1,70 @@
+#ifndef CCNET_STATISTICS_RECORDER_H
+#define CCNET_STATISTICS_RECORDER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "device_statistics.h"
+
+namespace ccnet {
+
+	// collects the protocol counters and the command latencies of a device;
+	// the device thread updates relaxed atomic counters only,
+	// so the snapshot may be taken from any thread without locking the device out
+	class statistics_recorder {
+		public:
+			enum class counter : std::uint8_t {
+				commands,
+				acks,
+				naks,
+				illegal_commands,
+				timeouts,
+				crc_errors,
+				sync_losses,
+				retries,
+				journal_errors
+			};
+
+			statistics_recorder();
+
+			statistics_recorder(const statistics_recorder& other) = delete;
+
+			statistics_recorder& operator=(const statistics_recorder& other) = delete;
+
+			void increment(counter counter_id, std::uint64_t value = 1);
+			void record_latency(std::uint8_t command_code, std::chrono::microseconds latency);
+			// records the time from sending a frame to receiving the response to it
+			void record_exchange_latency(std::chrono::microseconds latency);
+
+			device_statistics get_snapshot() const;
+
+		private:
+			struct latency_counters {
+				latency_counters();
+
+				std::array<std::atomic<std::uint64_t>, latency_histogram::buckets_count> buckets;
+				std::atomic<std::uint64_t> count;
+				// in microseconds
+				std::atomic<std::uint64_t> total_latency;
+			};
+
+		private:
+			static void record(latency_counters& entry, std::chrono::microseconds latency);
+			static latency_histogram read(const latency_counters& entry);
+
+		private:
+			// the codes of the CCNET commands lie between RESET and REQUEST STATISTICS
+			static const std::uint8_t command_code_min = 0x30;
+			static const std::uint8_t command_code_max = 0x60;
+			static const std::size_t counters_count = 9;
+
+			std::array<std::atomic<std::uint64_t>, counters_count> counters;
+			std::array<latency_counters, command_code_max - command_code_min + 1> latencies;
+			latency_counters exchange_latencies;
+	};
+
+}
+
+#endif // CCNET_STATISTICS_RECORDER_H
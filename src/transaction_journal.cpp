@@ -0,0 +1,187 @@
+#include "transaction_journal.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <boost/crc.hpp>
+#include "utility.h"
+
+using namespace boost::interprocess;
+using namespace ccnet;
+
+// the record layout, the integers are stored in little-endian byte order
+const std::size_t record_size = 40;
+const std::size_t sequence_number_offset = 0;
+const std::size_t time_offset = 8;
+const std::size_t denomination_offset = 16;
+const std::size_t currency_code_offset = 24;
+const std::size_t device_address_offset = 28;
+const std::size_t event_offset = 29;
+const std::size_t state_offset = 30;
+const std::size_t state_info_offset = 31;
+// covers the bytes preceding it
+const std::size_t crc_offset = 36;
+
+// the file grows by 640 KiB
+const std::size_t records_per_chunk = 16384;
+
+std::uint32_t get_record_crc(const std::uint8_t* record) {
+	boost::crc_32_type crc;
+	crc.process_bytes(record, crc_offset);
+	return crc.checksum();
+}
+
+// the record is valid if it is complete and follows the previous one
+bool is_record_valid(const std::uint8_t* record, std::uint64_t sequence_number) {
+	return (load_uint(record + sequence_number_offset, sizeof(std::uint64_t)) == sequence_number)
+		&& (load_uint(record + crc_offset, sizeof(std::uint32_t)) == get_record_crc(record));
+}
+
+journal_record decode_record(const std::uint8_t* data) {
+	journal_record record;
+
+	record.sequence_number = load_uint(data + sequence_number_offset, sizeof(std::uint64_t));
+	record.time = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+		std::chrono::microseconds((std::int64_t)load_uint(data + time_offset, sizeof(std::uint64_t)))));
+	record.cash.denomination = load_uint(data + denomination_offset, sizeof(std::uint64_t));
+	record.cash.packed_currency_code = (std::uint32_t)load_uint(data + currency_code_offset, sizeof(std::uint32_t));
+	record.device_address = data[device_address_offset];
+	record.event = (journal_event)data[event_offset];
+	record.state = (device_state_code)data[state_offset];
+	record.state_info = data[state_info_offset];
+
+	return record;
+}
+
+transaction_journal::transaction_journal(const std::string& path) :
+	path(path),
+	file(),
+	region(),
+	records_capacity(0),
+	records_count(0) {
+	std::size_t file_size = 0;
+	{
+		// create the file if it does not exist
+		std::ofstream file_stream(path, std::ios::binary | std::ios::app);
+		if (!file_stream) {
+			throw std::runtime_error("unable to open journal");
+		}
+
+		file_stream.seekp(0, std::ios::end);
+		file_size = (std::size_t)file_stream.tellp();
+	}
+
+	this->grow(std::max<std::size_t>((file_size + record_size * records_per_chunk - 1) / (record_size * records_per_chunk), 1) * records_per_chunk);
+
+	// the records follow each other up to the first one torn or never written
+	const std::uint8_t* records = static_cast<const std::uint8_t*>(this->region.get_address());
+	while ((this->records_count < this->records_capacity) && is_record_valid(records + this->records_count * record_size, this->records_count + 1)) {
+		++this->records_count;
+	}
+}
+
+void transaction_journal::append(journal_record& record) {
+	if (this->records_count == this->records_capacity) {
+		this->grow(this->records_capacity + records_per_chunk);
+	}
+
+	record.sequence_number = this->records_count + 1;
+	record.time = std::chrono::system_clock::now();
+
+	std::uint8_t* data = static_cast<std::uint8_t*>(this->region.get_address()) + this->records_count * record_size;
+	// a torn record left by a crash is overwritten
+	std::memset(data, 0, record_size);
+	store_uint(data + sequence_number_offset, record.sequence_number, sizeof(std::uint64_t));
+	store_uint(data + time_offset, (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(record.time.time_since_epoch()).count(), sizeof(std::uint64_t));
+	store_uint(data + denomination_offset, record.cash.denomination, sizeof(std::uint64_t));
+	store_uint(data + currency_code_offset, record.cash.packed_currency_code, sizeof(std::uint32_t));
+	data[device_address_offset] = record.device_address;
+	data[event_offset] = (std::uint8_t)record.event;
+	data[state_offset] = (std::uint8_t)record.state;
+	data[state_info_offset] = record.state_info;
+	// the checksum completes the record
+	store_uint(data + crc_offset, get_record_crc(data), sizeof(std::uint32_t));
+
+	++this->records_count;
+}
+
+void transaction_journal::flush() {
+	this->region.flush(0, this->records_count * record_size, false);
+}
+
+std::uint64_t transaction_journal::get_last_sequence_number() const {
+	return this->records_count;
+}
+
+std::vector<journal_record> transaction_journal::read_records(std::uint64_t first_sequence_number) const {
+	std::vector<journal_record> records;
+	const std::uint8_t* data = static_cast<const std::uint8_t*>(this->region.get_address());
+
+	for (std::size_t i = (first_sequence_number > 0) ? (std::size_t)(first_sequence_number - 1) : 0; i < this->records_count; ++i) {
+		records.push_back(decode_record(data + i * record_size));
+	}
+
+	return records;
+}
+
+std::vector<journal_record> transaction_journal::get_unsettled_records() const {
+	std::map<std::uint8_t, journal_record> unsettled_records;
+	const std::uint8_t* data = static_cast<const std::uint8_t*>(this->region.get_address());
+
+	for (std::size_t i = 0; i < this->records_count; ++i) {
+		const journal_record record = decode_record(data + i * record_size);
+
+		switch (record.event) {
+			case journal_event::bill_escrowed:
+			case journal_event::stack_requested:
+			case journal_event::return_requested:
+			case journal_event::power_up_with_bill: {
+				unsettled_records[record.device_address] = record;
+				break;
+			}
+			case journal_event::bill_stacked:
+			case journal_event::bill_returned: {
+				unsettled_records.erase(record.device_address);
+				break;
+			}
+			default: {
+				break;
+			}
+		}
+	}
+
+	std::vector<journal_record> records;
+	for (std::map<std::uint8_t, journal_record>::const_iterator iter = unsettled_records.cbegin(); iter != unsettled_records.cend(); ++iter) {
+		records.push_back(iter->second);
+	}
+
+	return records;
+}
+
+void transaction_journal::grow(std::size_t records_capacity) {
+	try {
+		{
+			std::fstream file_stream(this->path, std::ios::binary | std::ios::in | std::ios::out);
+			file_stream.seekg(0, std::ios::end);
+
+			// the last byte extends the file, the rest reads as zeros
+			if (file_stream.tellg() < std::streamoff(records_capacity * record_size)) {
+				file_stream.seekp(std::streamoff(records_capacity * record_size - 1));
+				file_stream.put(0);
+			}
+
+			if (!file_stream) {
+				throw std::runtime_error("unable to extend journal");
+			}
+		}
+
+		this->region = mapped_region();
+		this->file = file_mapping(this->path.c_str(), read_write);
+		this->region = mapped_region(this->file, read_write);
+	} catch (interprocess_exception) {
+		throw std::runtime_error("unable to map journal");
+	}
+
+	this->records_capacity = records_capacity;
+}
@@ -1,5 +1,5 @@
 #include "utility.h"
-#include <exception>
+#include <stdexcept>
 
 void set_bit(std::uint8_t& byte, std::uint8_t bit_number) {
 	byte = byte | (1 << bit_number);
@@ -11,7 +11,7 @@ bool is_bit_set(std::uint8_t byte, std::uint8_t bit_number) {
 
 std::uint64_t power(std::uint64_t base, std::uint64_t exponent) {
 	if ((base == 0) && (exponent == 0)) {
-		throw std::exception("invalid arguments");
+		throw std::runtime_error("invalid arguments");
 	}
 
 	std::uint64_t result = 1;
@@ -32,3 +32,19 @@ std::string trim(const std::string& string) {
 	result.erase(string.find_last_not_of(" \n\r\t") + 1);
 	return result;
 }
+
+void store_uint(std::uint8_t* data, std::uint64_t value, std::size_t size) {
+	for (std::size_t i = 0; i < size; ++i) {
+		data[i] = (std::uint8_t)(value >> (8 * i));
+	}
+}
+
+std::uint64_t load_uint(const std::uint8_t* data, std::size_t size) {
+	std::uint64_t value = 0;
+
+	for (std::size_t i = size; i > 0; --i) {
+		value = (value << 8) | data[i - 1];
+	}
+
+	return value;
+}
@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -10,3 +11,8 @@ std::uint64_t power(std::uint64_t base, std::uint64_t exponent);
 std::uint64_t get_abs_exponent(std::uint8_t byte);
 
 std::string trim(const std::string& string);
+
+// store and load the unsigned integers of the size in little-endian byte order
+void store_uint(std::uint8_t* data, std::uint64_t value, std::size_t size);
+
+std::uint64_t load_uint(const std::uint8_t* data, std::size_t size);
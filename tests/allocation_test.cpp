@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <boost/asio.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include "allocation_counter.h"
+#include "bill_validator.h"
+#include "bus.h"
+#include "frame.h"
+#include "loopback_device.h"
+#include "loopback_transport.h"
+#include "statistics_recorder.h"
+
+using namespace ccnet;
+
+// the command/response path is expected not to touch the heap once the device has been initialized
+
+const std::uint8_t device_address = 0x03;
+const std::uint8_t poll_command = 0x33;
+const std::uint8_t idling_state = 0x14;
+
+const int exchanges_count = 1000;
+
+
+class idle_operator : public bill_validator_operator {
+	public:
+		std::future<void> drop_cassette_full() override {
+			return std::future<void>();
+		}
+
+		std::future<void> drop_cassette_installed() override {
+			return std::future<void>();
+		}
+
+		std::future<void> drop_cassette_removed() override {
+			return std::future<void>();
+		}
+
+		std::future<cash_action> request_cash_action(const cash_type& cash_type) override {
+			return std::future<cash_action>();
+		}
+
+		std::future<void> cash_accepted(const cash_type& cash_type) override {
+			return std::future<void>();
+		}
+
+		std::future<void> cash_returned(const cash_type& cash_type) override {
+			return std::future<void>();
+		}
+};
+
+// the device answers as soon as the command is written, so the reads never wait for the timeouts;
+// the line silence is left out
+connection_options get_loopback_options(loopback_device& device) {
+	connection_options options(9600, 8, connection_options::parity_type::none, connection_options::stop_bits_type::one,
+		std::chrono::milliseconds(10), std::chrono::milliseconds(5), std::chrono::milliseconds(0), std::chrono::milliseconds(0));
+	options.custom_transport = [&device](const std::string& port_name, const connection_options& options) {
+		return std::unique_ptr<serial_transport>(new loopback_transport([&device](const frame& written_frame, frame& response) {
+			device.respond(written_frame, response);
+		}));
+	};
+	return options;
+}
+
+// the exchange the handler makes for a poll: the command, the response and the confirmation
+void exchange_poll(bus& line, statistics_recorder& recorder) {
+	frame command_frame;
+	encode_frame(command_frame, device_address, poll_command, nullptr, 0);
+	line.write_frame(command_frame);
+
+	std::uint8_t response_address = 0;
+	frame payload;
+	BOOST_TEST(line.read_frame(response_address, payload, recorder));
+	BOOST_TEST_EQ(response_address, device_address);
+	BOOST_TEST_EQ(payload.size(), 1u);
+	BOOST_TEST_EQ(payload[0], idling_state);
+
+	line.send_ack(response_address);
+}
+
+void test_bus_exchange() {
+	loopback_device device;
+	boost::asio::io_service io_service;
+	bus line(io_service, "loopback", get_loopback_options(device));
+	statistics_recorder recorder;
+
+	// the first exchange may initialize the statics of the path
+	exchange_poll(line, recorder);
+
+	const std::uint64_t allocations_before = allocations_count.load(std::memory_order_relaxed);
+	for (int i = 0; i < exchanges_count; ++i) {
+		exchange_poll(line, recorder);
+	}
+	BOOST_TEST_EQ(allocations_count.load(std::memory_order_relaxed) - allocations_before, 0u);
+	BOOST_TEST_EQ(device.get_polls_count(), (std::uint64_t)exchanges_count + 1);
+}
+
+void test_bill_validator_polls() {
+	typedef std::chrono::steady_clock clock;
+
+	loopback_device device;
+
+	{
+		idle_operator validator_operator;
+		const poll_policy policy(std::chrono::milliseconds(0), std::chrono::milliseconds(0), std::chrono::milliseconds(0), std::chrono::milliseconds(1000), std::chrono::milliseconds(0));
+		bill_validator validator("loopback", &validator_operator, policy, escrow_policy(), get_loopback_options(device));
+
+		const clock::time_point deadline = clock::now() + std::chrono::seconds(10);
+		while ((!validator.get_snapshot()->is_initialized) && (clock::now() < deadline)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		BOOST_TEST(validator.get_snapshot()->is_initialized);
+
+		// the polls following the initialization publish the idling state once
+		const std::uint64_t initial_polls_count = device.get_polls_count();
+		while ((device.get_polls_count() - initial_polls_count < 10) && (clock::now() < deadline)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		// the test thread only sleeps while the handler polls
+		const std::uint64_t polls_before = device.get_polls_count();
+		const std::uint64_t allocations_before = allocations_count.load(std::memory_order_relaxed);
+		while ((device.get_polls_count() - polls_before < exchanges_count) && (clock::now() < deadline)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		const std::uint64_t allocations = allocations_count.load(std::memory_order_relaxed) - allocations_before;
+
+		BOOST_TEST_GE(device.get_polls_count() - polls_before, (std::uint64_t)exchanges_count);
+		BOOST_TEST_EQ(allocations, 0u);
+	}
+}
+
+int main() {
+	test_bus_exchange();
+	test_bill_validator_polls();
+
+	return boost::report_errors();
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <boost/core/lightweight_test.hpp>
+#include "codec.h"
+#include "frame.h"
+
+using namespace ccnet;
+
+// the layout of the REQUEST STATISTICS response
+const std::size_t statistics_size = 4356;
+const std::size_t sets_offset = 32;
+const std::size_t set_size = 179;
+const std::size_t denominations_offset = sets_offset + 16 * set_size + 20 * 66 + 20 * 1;
+const std::size_t unrecognized_bills_offset = 162;
+const std::size_t jams_offset = 171;
+
+extended_frame get_empty_statistics() {
+	extended_frame statistics(statistics_size);
+	const std::uint8_t denomination[] = { 0x0a, 'R', 'U', 'S', 0x02 };
+	std::copy_n(denomination, sizeof(denomination), statistics.begin() + denominations_offset + 3 * 5);
+	statistics[denominations_offset + 20 * 5] = '.';
+	return statistics;
+}
+
+// writes the big-endian counters of the set: the inserted bills, the accepted ones of the fourth denomination,
+// the unrecognized ones and the jams at the exit
+void set_counters(extended_frame& statistics, std::size_t set_number, std::uint16_t inserted_count, std::uint16_t accepted_count, std::uint16_t unrecognized_count, std::uint8_t jams_count) {
+	std::uint8_t* set = statistics.data() + sets_offset + set_number * set_size;
+	set[0] = (std::uint8_t)(inserted_count >> 8);
+	set[1] = (std::uint8_t)inserted_count;
+	set[2 + 3 * 2] = (std::uint8_t)(accepted_count >> 8);
+	set[2 + 3 * 2 + 1] = (std::uint8_t)accepted_count;
+	set[unrecognized_bills_offset] = (std::uint8_t)(unrecognized_count >> 8);
+	set[unrecognized_bills_offset + 1] = (std::uint8_t)unrecognized_count;
+	set[jams_offset + 7] = jams_count;
+}
+
+void test_decoding() {
+	extended_frame statistics = get_empty_statistics();
+	set_counters(statistics, 15, 0x0102, 0x0100, 2, 3);
+	statistics[5] = 0x26;
+
+	const statistics_report report = decode_statistics_report(statistics);
+
+	BOOST_TEST_EQ(report.reset_time[0], 0x26);
+	BOOST_TEST_EQ(report.sets[14].bills_inserted_count, 0u);
+	BOOST_TEST_EQ(report.sets[15].bills_inserted_count, 0x0102u);
+	BOOST_TEST_EQ(report.sets[15].bills_accepted_counts[3], 0x0100u);
+	BOOST_TEST_EQ(report.sets[15].get_bills_accepted_count(), 0x0100u);
+	BOOST_TEST_EQ(report.sets[15].get_bills_rejected_count(), 2u);
+	BOOST_TEST_EQ(report.sets[15].jams_counts[(std::size_t)device_counters::jam_place::exit], 3u);
+	BOOST_TEST_EQ(report.sets[15].get_jams_count(), 3u);
+
+	// the tenth of the denomination is raised to the exponent
+	BOOST_TEST_EQ(report.denominations[3].denomination, 100000u);
+	BOOST_TEST_EQ(report.denominations[3].get_currency_code(), "RUS");
+	BOOST_TEST_EQ(report.denominations[0].denomination, 0u);
+}
+
+void test_invalid_data() {
+	BOOST_TEST_THROWS(decode_statistics_report(extended_frame(1, 0x31)), std::runtime_error);
+	BOOST_TEST_THROWS(decode_statistics_report(extended_frame(statistics_size - 1)), std::runtime_error);
+}
+
+void test_delta_within_set() {
+	extended_frame previous_statistics = get_empty_statistics();
+	set_counters(previous_statistics, 15, 100, 90, 10, 1);
+	extended_frame current_statistics = get_empty_statistics();
+	set_counters(current_statistics, 15, 130, 115, 15, 1);
+
+	const device_counters delta = get_counters_delta(decode_statistics_report(current_statistics), decode_statistics_report(previous_statistics));
+
+	BOOST_TEST_EQ(delta.bills_inserted_count, 30u);
+	BOOST_TEST_EQ(delta.get_bills_accepted_count(), 25u);
+	BOOST_TEST_EQ(delta.unrecognized_bills_count, 5u);
+	BOOST_TEST_EQ(delta.get_jams_count(), 0u);
+	BOOST_TEST_EQ(delta.denominations[3].denomination, 100000u);
+}
+
+void test_delta_across_sets() {
+	// the set current at the previous report is completed and a new one is started,
+	// the older sets move towards the first one
+	extended_frame previous_statistics = get_empty_statistics();
+	set_counters(previous_statistics, 14, 10000, 9000, 1000, 4);
+	set_counters(previous_statistics, 15, 9990, 8990, 1000, 2);
+	extended_frame current_statistics = get_empty_statistics();
+	set_counters(current_statistics, 13, 10000, 9000, 1000, 4);
+	set_counters(current_statistics, 14, 10000, 8998, 1002, 2);
+	set_counters(current_statistics, 15, 5, 5, 0, 1);
+
+	const device_counters delta = get_counters_delta(decode_statistics_report(current_statistics), decode_statistics_report(previous_statistics));
+
+	BOOST_TEST_EQ(delta.bills_inserted_count, 15u);
+	BOOST_TEST_EQ(delta.get_bills_accepted_count(), 13u);
+	BOOST_TEST_EQ(delta.unrecognized_bills_count, 2u);
+	BOOST_TEST_EQ(delta.get_jams_count(), 1u);
+}
+
+void test_delta_after_reset() {
+	extended_frame previous_statistics = get_empty_statistics();
+	set_counters(previous_statistics, 15, 100, 90, 10, 1);
+	extended_frame current_statistics = get_empty_statistics();
+	set_counters(current_statistics, 15, 7, 6, 1, 0);
+	current_statistics[5] = 0x26;
+
+	const device_counters delta = get_counters_delta(decode_statistics_report(current_statistics), decode_statistics_report(previous_statistics));
+
+	BOOST_TEST_EQ(delta.bills_inserted_count, 7u);
+	BOOST_TEST_EQ(delta.get_bills_accepted_count(), 6u);
+}
+
+int main() {
+	test_decoding();
+	test_invalid_data();
+	test_delta_within_set();
+	test_delta_across_sets();
+	test_delta_after_reset();
+
+	return boost::report_errors();
+}
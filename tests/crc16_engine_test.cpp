@@ -0,0 +1,98 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <boost/core/lightweight_test.hpp>
+#include "crc16_engine.h"
+
+using namespace ccnet;
+
+// the bitwise CRC of the CCNET specification the table-driven engine replaces
+std::uint16_t get_reference_crc(const std::uint8_t* data, std::size_t size) {
+	const std::uint16_t polynomial = 0x8408;
+	std::uint16_t crc = 0;
+
+	for (std::size_t i = 0; i < size; ++i) {
+		crc ^= data[i];
+
+		for (std::uint8_t bit_number = 0; bit_number < 8; ++bit_number) {
+			crc = (crc & 0x0001) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+		}
+	}
+
+	return crc;
+}
+
+void test_known_frame() {
+	// POLL sent to the bill validator, transmitted as 02 03 06 33 DA 81
+	const std::uint8_t poll_frame[] = { 0x02, 0x03, 0x06, 0x33 };
+
+	BOOST_TEST_EQ(crc16_engine::compute(poll_frame, sizeof(poll_frame)), 0x81da);
+	BOOST_TEST_EQ(crc16_engine::compute(poll_frame, sizeof(poll_frame)), get_reference_crc(poll_frame, sizeof(poll_frame)));
+	BOOST_TEST_EQ(crc16_engine::compute(poll_frame, 0), 0);
+}
+
+void test_random_lengths_and_alignments() {
+	std::mt19937 generator(20021101);
+	std::uniform_int_distribution<int> byte_distribution(0, 0xff);
+
+	std::vector<std::uint8_t> buffer(4096 + 8);
+	for (std::vector<std::uint8_t>::iterator iter = buffer.begin(); iter != buffer.end(); ++iter) {
+		*iter = (std::uint8_t)byte_distribution(generator);
+	}
+
+	// every length up to a few slices at every offset within a slice,
+	// then random blocks up to the largest extended frame
+	for (std::size_t offset = 0; offset < 8; ++offset) {
+		for (std::size_t size = 0; size <= 64; ++size) {
+			BOOST_TEST_EQ(crc16_engine::compute(buffer.data() + offset, size), get_reference_crc(buffer.data() + offset, size));
+		}
+	}
+
+	std::uniform_int_distribution<std::size_t> offset_distribution(0, 7);
+	std::uniform_int_distribution<std::size_t> size_distribution(0, 4096);
+	for (int i = 0; i < 1000; ++i) {
+		const std::size_t offset = offset_distribution(generator);
+		const std::size_t size = size_distribution(generator);
+
+		BOOST_TEST_EQ(crc16_engine::compute(buffer.data() + offset, size), get_reference_crc(buffer.data() + offset, size));
+	}
+}
+
+void test_incremental_update() {
+	std::mt19937 generator(19200);
+	std::uniform_int_distribution<int> byte_distribution(0, 0xff);
+
+	std::vector<std::uint8_t> data(300);
+	for (std::vector<std::uint8_t>::iterator iter = data.begin(); iter != data.end(); ++iter) {
+		*iter = (std::uint8_t)byte_distribution(generator);
+	}
+
+	const std::uint16_t expected_crc = get_reference_crc(data.data(), data.size());
+
+	// the bytes split into two blocks at any position
+	for (std::size_t split = 0; split <= data.size(); ++split) {
+		crc16_engine engine;
+		engine.update(data.data(), split).update(data.data() + split, data.size() - split);
+
+		BOOST_TEST_EQ(engine.get_value(), expected_crc);
+	}
+
+	// the bytes as they arrive one by one
+	crc16_engine engine;
+	for (std::vector<std::uint8_t>::const_iterator iter = data.cbegin(); iter != data.cend(); ++iter) {
+		engine.update_byte(*iter);
+	}
+	BOOST_TEST_EQ(engine.get_value(), expected_crc);
+
+	engine.reset();
+	BOOST_TEST_EQ(engine.update(data).get_value(), expected_crc);
+}
+
+int main() {
+	test_known_frame();
+	test_random_lengths_and_alignments();
+	test_incremental_update();
+
+	return boost::report_errors();
+}
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/core/lightweight_test.hpp>
+#include "frame.h"
+#include "frame_parser.h"
+#include "protocol.h"
+
+using namespace ccnet;
+
+// passes the bytes to the parser in chunks, the way the bulk reads of a line do,
+// and collects the results of parsing them; the last frame is left in the parsed frame
+std::vector<frame_parser::result> receive(frame_parser& parser, const std::vector<std::uint8_t>& line, std::size_t chunk_size, frame& parsed_frame) {
+	std::vector<frame_parser::result> results;
+
+	for (std::size_t offset = 0; offset < line.size();) {
+		const std::size_t size = std::min(std::min(line.size() - offset, chunk_size), parser.get_write_size());
+		std::copy_n(line.data() + offset, size, parser.get_write_position());
+		parser.commit(size);
+		offset += size;
+
+		frame_parser::result parse_result;
+		while ((parse_result = parser.parse(parsed_frame)) != frame_parser::result::incomplete) {
+			results.push_back(parse_result);
+		}
+	}
+
+	return results;
+}
+
+std::vector<std::uint8_t> get_test_data(std::size_t size) {
+	std::vector<std::uint8_t> data(size);
+	for (std::size_t i = 0; i < size; ++i) {
+		data[i] = (std::uint8_t)(i * 7 + 1);
+	}
+	return data;
+}
+
+void test_leading_garbage() {
+	// the bytes received before the response, e.g. the tail of an earlier one
+	const std::vector<std::uint8_t> data = get_test_data(10);
+	frame response;
+	encode_frame(response, 0x03, data[0], data.data() + 1, data.size() - 1);
+
+	std::vector<std::uint8_t> line = { 0xff, 0x10, 0x33, 0x00, 0xfe };
+	line.insert(line.end(), response.cbegin(), response.cend());
+
+	frame_parser parser;
+	frame parsed_frame;
+	const std::vector<frame_parser::result> results = receive(parser, line, 64, parsed_frame);
+
+	BOOST_TEST_EQ(results.size(), 1u);
+	BOOST_TEST(results[0] == frame_parser::result::frame_received);
+	BOOST_TEST(std::equal(parsed_frame.cbegin(), parsed_frame.cend(), response.cbegin()));
+	BOOST_TEST_EQ(parser.get_sync_losses_count(), 1u);
+	BOOST_TEST_NOT(parser.is_receiving());
+}
+
+void test_false_sync_byte() {
+	frame response;
+	encode_frame(response, 0x03, 0x14, nullptr, 0);
+
+	// a sync byte followed by a length too short for a frame is skipped,
+	// the next one starts a frame failing the check which overlaps the response
+	std::vector<std::uint8_t> line = { 0x02, 0x01, 0x02, 0x03, 0x06, 0x10 };
+	line.insert(line.end(), response.cbegin(), response.cend());
+
+	frame_parser parser;
+	frame parsed_frame;
+	const std::vector<frame_parser::result> results = receive(parser, line, 64, parsed_frame);
+
+	BOOST_TEST_EQ(results.size(), 2u);
+	BOOST_TEST(results[0] == frame_parser::result::crc_error);
+	BOOST_TEST(results[1] == frame_parser::result::frame_received);
+	BOOST_TEST(std::equal(parsed_frame.cbegin(), parsed_frame.cend(), response.cbegin()));
+	BOOST_TEST_EQ(parser.get_sync_losses_count(), 1u);
+}
+
+void test_frame_split_across_reads() {
+	const std::vector<std::uint8_t> data = get_test_data(34);
+	frame response;
+	encode_frame(response, 0x03, data[0], data.data() + 1, data.size() - 1);
+
+	// the bytes arrive one by one, the frame is complete with the last one
+	frame_parser parser;
+	frame parsed_frame;
+	const std::vector<std::uint8_t> head(response.cbegin(), response.cend() - 1);
+	BOOST_TEST(receive(parser, head, 1, parsed_frame).empty());
+	BOOST_TEST(parser.is_receiving());
+	BOOST_TEST_EQ(parser.get_missing_size(), 1u);
+
+	const std::vector<frame_parser::result> results = receive(parser, std::vector<std::uint8_t>(1, response[response.size() - 1]), 1, parsed_frame);
+	BOOST_TEST_EQ(results.size(), 1u);
+	BOOST_TEST(results[0] == frame_parser::result::frame_received);
+	BOOST_TEST(std::equal(parsed_frame.cbegin(), parsed_frame.cend(), response.cbegin()));
+
+	// the frames wrap around the end of the ring buffer in reads not matching their boundaries
+	std::vector<std::uint8_t> line;
+	for (int i = 0; i < 100; ++i) {
+		line.insert(line.end(), response.cbegin(), response.cend());
+	}
+
+	const std::vector<frame_parser::result> stream_results = receive(parser, line, 7, parsed_frame);
+	BOOST_TEST_EQ(stream_results.size(), 100u);
+	BOOST_TEST(std::count(stream_results.cbegin(), stream_results.cend(), frame_parser::result::frame_received) == 100);
+	BOOST_TEST(std::equal(parsed_frame.cbegin(), parsed_frame.cend(), response.cbegin()));
+	BOOST_TEST_EQ(parser.get_sync_losses_count(), 0u);
+}
+
+void test_frames_around_extended_response() {
+	// a response longer than the ring buffer between two short frames,
+	// received in chunks which do not match the frame boundaries
+	const std::vector<std::uint8_t> data = get_test_data(4356);
+	frame first_frame;
+	encode_frame(first_frame, 0x03, 0x14, nullptr, 0);
+	extended_frame response;
+	encode_extended_frame(response, 0x03, nullptr, 0, data.data(), data.size());
+	frame last_frame;
+	encode_frame(last_frame, 0x03, ack, nullptr, 0);
+
+	BOOST_TEST_EQ(response[lng_offset], extended_lng);
+	BOOST_TEST_EQ((response[3] << 8) | response[4], response.size());
+
+	std::vector<std::uint8_t> line(first_frame.cbegin(), first_frame.cend());
+	line.insert(line.end(), response.cbegin(), response.cend());
+	const std::size_t last_frame_offset = line.size();
+	line.insert(line.end(), last_frame.cbegin(), last_frame.cend());
+
+	frame_parser parser;
+	frame parsed_frame;
+	const std::vector<std::uint8_t> head(line.cbegin(), line.cbegin() + first_frame.size() + 50);
+	std::vector<frame_parser::result> results = receive(parser, head, 100, parsed_frame);
+
+	BOOST_TEST(parser.is_receiving_extended_frame());
+	BOOST_TEST_EQ(parser.get_missing_size(), response.size() - 50);
+
+	const std::vector<std::uint8_t> body(line.cbegin() + head.size(), line.cbegin() + last_frame_offset);
+	const std::vector<frame_parser::result> body_results = receive(parser, body, 100, parsed_frame);
+	results.insert(results.end(), body_results.cbegin(), body_results.cend());
+
+	BOOST_TEST(parser.get_extended_frame() == response);
+
+	const std::vector<std::uint8_t> tail(line.cbegin() + last_frame_offset, line.cend());
+	const std::vector<frame_parser::result> tail_results = receive(parser, tail, 100, parsed_frame);
+	results.insert(results.end(), tail_results.cbegin(), tail_results.cend());
+
+	BOOST_TEST_EQ(results.size(), 3u);
+	BOOST_TEST(results[0] == frame_parser::result::frame_received);
+	BOOST_TEST(results[1] == frame_parser::result::extended_frame_received);
+	BOOST_TEST(results[2] == frame_parser::result::frame_received);
+	BOOST_TEST(std::equal(parsed_frame.cbegin(), parsed_frame.cend(), last_frame.cbegin()));
+	BOOST_TEST_EQ(parser.get_sync_losses_count(), 0u);
+}
+
+void test_corrupted_extended_frame() {
+	const std::vector<std::uint8_t> data = get_test_data(1000);
+	extended_frame response;
+	encode_extended_frame(response, 0x03, nullptr, 0, data.data(), data.size());
+	response[500] ^= 0x01;
+
+	frame_parser parser;
+	frame parsed_frame;
+	const std::vector<frame_parser::result> results = receive(parser, response, 64, parsed_frame);
+
+	// the frame is dropped as a whole, its address is reported for the repetition
+	BOOST_TEST_EQ(results.size(), 1u);
+	BOOST_TEST(results[0] == frame_parser::result::crc_error);
+	BOOST_TEST_EQ(parsed_frame[adr_offset], 0x03);
+	BOOST_TEST_NOT(parser.is_receiving());
+}
+
+void test_controller_frame_with_subcommand() {
+	// the length of a DOWNLOAD write follows the subcommand
+	const std::vector<std::uint8_t> data = get_test_data(3 + 512);
+	const std::uint8_t prefix[] = { subcommand_command, 0x02 };
+	extended_frame command_frame;
+	encode_extended_frame(command_frame, 0x03, prefix, sizeof(prefix), data.data(), data.size());
+
+	BOOST_TEST_EQ((command_frame[5] << 8) | command_frame[6], command_frame.size());
+
+	frame_parser parser(frame_parser::frame_sender::controller);
+	frame parsed_frame;
+	const std::vector<frame_parser::result> results = receive(parser, command_frame, 7, parsed_frame);
+
+	BOOST_TEST_EQ(results.size(), 1u);
+	BOOST_TEST(results[0] == frame_parser::result::extended_frame_received);
+	BOOST_TEST(parser.get_extended_frame() == command_frame);
+}
+
+void test_broken_off_extended_frame() {
+	const std::vector<std::uint8_t> data = get_test_data(600);
+	extended_frame response;
+	encode_extended_frame(response, 0x03, nullptr, 0, data.data(), data.size());
+	frame next_frame;
+	encode_frame(next_frame, 0x03, ack, nullptr, 0);
+
+	frame_parser parser;
+	frame parsed_frame;
+	BOOST_TEST(receive(parser, std::vector<std::uint8_t>(response.cbegin(), response.cbegin() + 300), 300, parsed_frame).empty());
+	BOOST_TEST(parser.is_receiving());
+
+	// the rest of the frame does not arrive in time
+	parser.resynchronise();
+	BOOST_TEST_NOT(parser.is_receiving());
+	BOOST_TEST_EQ(parser.get_sync_losses_count(), 1u);
+
+	const std::vector<frame_parser::result> results = receive(parser, std::vector<std::uint8_t>(next_frame.cbegin(), next_frame.cend()), 100, parsed_frame);
+	BOOST_TEST_EQ(results.size(), 1u);
+	BOOST_TEST(results[0] == frame_parser::result::frame_received);
+}
+
+int main() {
+	test_leading_garbage();
+	test_false_sync_byte();
+	test_frame_split_across_reads();
+	test_frames_around_extended_response();
+	test_corrupted_extended_frame();
+	test_controller_frame_with_subcommand();
+	test_broken_off_extended_frame();
+
+	return boost::report_errors();
+}
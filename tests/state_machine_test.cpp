@@ -0,0 +1,116 @@
+#include <string>
+#include <boost/core/lightweight_test.hpp>
+#include "state_machine.h"
+
+using namespace ccnet;
+
+// records the handlers in the order they run,
+// each of them ends the dispatch if its result is set to false
+struct fake_context {
+	fake_context() :
+		calls(),
+		exit_accepting_result(true),
+		hold_to_escrow_result(true),
+		enter_escrow_result(true) { }
+
+	bool exit_accepting() {
+		this->calls += "exit_accepting ";
+		return this->exit_accepting_result;
+	}
+
+	bool hold_to_escrow() {
+		this->calls += "hold_to_escrow ";
+		return this->hold_to_escrow_result;
+	}
+
+	bool enter_escrow() {
+		this->calls += "enter_escrow ";
+		return this->enter_escrow_result;
+	}
+
+	bool enter_stacked() {
+		this->calls += "enter_stacked ";
+		return true;
+	}
+
+	std::string calls;
+	bool exit_accepting_result;
+	bool hold_to_escrow_result;
+	bool enter_escrow_result;
+};
+
+typedef state_machine<fake_context> fake_state_machine;
+
+constexpr fake_state_machine::state_hooks hooks[] = {
+	{ device_state_code::accepting, nullptr, &fake_context::exit_accepting },
+	{ device_state_code::escrow_pos, &fake_context::enter_escrow, nullptr },
+	{ device_state_code::bill_stacked, &fake_context::enter_stacked, nullptr }
+};
+
+constexpr fake_state_machine::transition transitions[] = {
+	{ device_state_code::holding, device_state_code::escrow_pos, &fake_context::hold_to_escrow },
+	{ device_state_code::accepting, device_state_code::escrow_pos, &fake_context::hold_to_escrow }
+};
+
+// the tables are built at compile time
+constexpr fake_state_machine machine(hooks, transitions);
+
+void test_handlers_order() {
+	fake_context context;
+
+	BOOST_TEST(machine.dispatch(context, device_state_code::accepting, device_state_code::escrow_pos));
+	BOOST_TEST_EQ(context.calls, "exit_accepting hold_to_escrow enter_escrow ");
+}
+
+void test_states_without_hooks() {
+	fake_context context;
+
+	BOOST_TEST(machine.dispatch(context, device_state_code::idling, device_state_code::rejecting));
+	BOOST_TEST(machine.dispatch(context, device_state_code::unknown, device_state_code::failure));
+	BOOST_TEST_EQ(context.calls, "");
+
+	// only the entry hook of the current state runs
+	BOOST_TEST(machine.dispatch(context, device_state_code::stacking, device_state_code::bill_stacked));
+	BOOST_TEST_EQ(context.calls, "enter_stacked ");
+}
+
+void test_transition_match() {
+	// the action is bound to the pair of the states, not to the current state alone
+	fake_context context;
+
+	BOOST_TEST(machine.dispatch(context, device_state_code::idling, device_state_code::escrow_pos));
+	BOOST_TEST_EQ(context.calls, "enter_escrow ");
+
+	context.calls.clear();
+	BOOST_TEST(machine.dispatch(context, device_state_code::holding, device_state_code::escrow_pos));
+	BOOST_TEST_EQ(context.calls, "hold_to_escrow enter_escrow ");
+}
+
+void test_dispatch_end() {
+	fake_context exit_context;
+	exit_context.exit_accepting_result = false;
+
+	BOOST_TEST_NOT(machine.dispatch(exit_context, device_state_code::accepting, device_state_code::escrow_pos));
+	BOOST_TEST_EQ(exit_context.calls, "exit_accepting ");
+
+	fake_context action_context;
+	action_context.hold_to_escrow_result = false;
+
+	BOOST_TEST_NOT(machine.dispatch(action_context, device_state_code::holding, device_state_code::escrow_pos));
+	BOOST_TEST_EQ(action_context.calls, "hold_to_escrow ");
+
+	fake_context entry_context;
+	entry_context.enter_escrow_result = false;
+
+	BOOST_TEST_NOT(machine.dispatch(entry_context, device_state_code::holding, device_state_code::escrow_pos));
+	BOOST_TEST_EQ(entry_context.calls, "hold_to_escrow enter_escrow ");
+}
+
+int main() {
+	test_handlers_order();
+	test_states_without_hooks();
+	test_transition_match();
+	test_dispatch_end();
+
+	return boost::report_errors();
+}